@@ -0,0 +1,83 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+static atomic<unsigned long long> allocations(0);
+static atomic<unsigned long long> allocatedBytes(0);
+
+unsigned long long heapAllocationCount()
+{
+	return allocations.load(memory_order_relaxed);
+}
+
+unsigned long long heapAllocatedBytes()
+{
+	return allocatedBytes.load(memory_order_relaxed);
+}
+
+static void* countedAllocate(size_t size)
+{
+	allocations.fetch_add(1, memory_order_relaxed);
+	allocatedBytes.fetch_add(size, memory_order_relaxed);
+	return malloc(size == 0 ? 1 : size);
+}
+
+// Replacements for the global allocation functions; every other form of new and delete forwards to these
+void* operator new(size_t size)
+{
+	void* pointer = countedAllocate(size);
+	if (pointer == nullptr)
+	{
+		throw bad_alloc();
+	}
+	return pointer;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+	return countedAllocate(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+	return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, const nothrow_t&) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer, const nothrow_t&) noexcept
+{
+	free(pointer);
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Every operator new in the program, on any thread, is counted by the replacements in AllocationCounter.cpp.
+// Compare the counts before and after a block of code to check that it does not allocate.
+unsigned long long heapAllocationCount();
+unsigned long long heapAllocatedBytes();
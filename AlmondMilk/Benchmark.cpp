@@ -0,0 +1,2148 @@
+#include "Benchmark.h"
+#include "AllocationCounter.h"
+#include "Camera.h"
+#include "CompactVertex.h"
+#include "Culling.h"
+#include "DemoScene.h"
+#include "DynamicResolution.h"
+#include "DrawSort.h"
+#include "FixedTimestep.h"
+#include "FramePacing.h"
+#include "FramePipeline.h"
+#include "Headless.h"
+#include "InputRecording.h"
+#include "MeshBuilder.h"
+#include "MeshGenerator.h"
+#include "ObjLoader.h"
+#include "OcclusionCulling.h"
+#include "Primitives.h"
+#include "RenderCamera.h"
+#include "Scene.h"
+#include "SceneConverter.h"
+#include "SceneFile.h"
+#include "ScenePool.h"
+#include "ShaderCache.h"
+#include "Shaders.h"
+#include "TransformKernel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <vector>
+#include <GLFW/glfw3.h>     // GLFW library
+
+// GLM Libraries
+#include <glm/gtc/matrix_transform.hpp> 
+
+using namespace std;
+
+int runPoolBenchmark(int copies, int frames)
+{
+	GLFWwindow* window = createOffscreenContext(64, 64);
+	if (!window)
+	{
+		return -1;
+	}
+
+	glEnable(GL_DEPTH_TEST);
+	GLuint shaderProgram = CreateShaderProgram(vertexShaderSource, fragmentShaderSource);
+
+	const GLfloat* primitives[] = { planeVertices, milkCubeVertices, milkCPyramidVertices, donutBoxVertices };
+	const GLsizei primitiveCounts[] = { planeVertexCount, milkCubeVertexCount, milkCPyramidVertexCount, donutBoxVertexCount };
+	const int primitiveTotal = 4;
+
+	// Per-VAO path: one VAO/VBO pair per object, as the scene was originally built
+	vector<GLuint> VAOs(copies * primitiveTotal), VBOs(copies * primitiveTotal);
+	vector<GLsizei> vertexCounts(copies * primitiveTotal);
+	glGenVertexArrays((GLsizei)VAOs.size(), VAOs.data());
+	glGenBuffers((GLsizei)VBOs.size(), VBOs.data());
+	for (size_t i = 0; i < VAOs.size(); i++)
+	{
+		int primitive = i % primitiveTotal;
+		vertexCounts[i] = primitiveCounts[primitive];
+		glBindVertexArray(VAOs[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, VBOs[i]);
+		glBufferData(GL_ARRAY_BUFFER, vertexCounts[i] * floatsPerVertex * sizeof(GLfloat), primitives[primitive], GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(GLfloat), (GLvoid*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(1);
+	}
+	glBindVertexArray(0);
+
+	// Pool path: each primitive welded and indexed once, every copy is an instance with its own transform
+	ScenePool pool;
+	Scene scene;
+	for (int p = 0; p < primitiveTotal; p++)
+	{
+		pool.addMesh(buildIndexedMesh(primitives[p], primitiveCounts[p]));
+	}
+	pool.upload();
+	for (int i = 0; i < copies * primitiveTotal; i++)
+	{
+		scene.addObject(i % primitiveTotal, glm::mat4(1.0f));
+	}
+	scene.selectAll();
+
+	BindCameraBlock(shaderProgram);
+	CameraUniformBuffer cameraBuffer;
+	cameraBuffer.create();
+	cameraBuffer.update(glm::mat4(1.0f), glm::mat4(1.0f));
+	RenderState renderState;
+	renderState.useProgram(shaderProgram);
+
+	// Time CPU submission only; glFinish keeps GPU work from one frame leaking into the next measurement
+	double perVAOMs = 0.0;
+	const glm::mat4 identity(1.0f);
+	for (int frame = 0; frame < frames; frame++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		auto start = chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < VAOs.size(); i++)
+		{
+			// Per-object model matrix upload, then bind and draw
+			glBindVertexArray(VAOs[i]);
+			for (GLuint column = 0; column < 4; column++)
+			{
+				glVertexAttrib4fv(instanceModelLocation + column, &identity[column][0]);
+			}
+			glDrawArrays(GL_TRIANGLES, 0, vertexCounts[i]);
+		}
+		auto end = chrono::high_resolution_clock::now();
+		perVAOMs += chrono::duration<double, milli>(end - start).count();
+		glFinish();
+	}
+
+	double poolMs = 0.0;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		auto start = chrono::high_resolution_clock::now();
+		scene.buildInstances(pool);
+		pool.uploadInstances(scene.instanceTransforms().data(), scene.instanceTransforms().size());
+		pool.draw(renderState, scene.drawBatches().data(), scene.drawBatches().size());
+		auto end = chrono::high_resolution_clock::now();
+		poolMs += chrono::duration<double, milli>(end - start).count();
+		glFinish();
+	}
+
+	cout << "Objects: " << VAOs.size() << ", frames: " << frames << endl;
+	cout << "Per-VAO path: " << VAOs.size() << " draw calls, " << perVAOMs / frames << " ms CPU submit per frame" << endl;
+	cout << "Pool path:    " << pool.stats().drawCalls << " draw calls, " << poolMs / frames << " ms CPU submit per frame (including transform upload)" << endl;
+
+	// Release GPU resources
+	renderState.invalidate();
+	glBindVertexArray(0);
+	glDeleteVertexArrays((GLsizei)VAOs.size(), VAOs.data());
+	glDeleteBuffers((GLsizei)VBOs.size(), VBOs.data());
+	pool.destroy();
+	cameraBuffer.destroy();
+	glDeleteProgram(shaderProgram);
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
+
+int runCompactVertexTest()
+{
+	int failures = 0;
+
+	// The four demo primitives, then every generated shape at each demo level of detail
+	vector<string> names = { "Plane", "Almond Milk base", "Almond Milk top", "Donut box" };
+	vector<IndexedMesh> meshes;
+	meshes.push_back(buildIndexedMesh(planeVertices, planeVertexCount));
+	meshes.push_back(buildIndexedMesh(milkCubeVertices, milkCubeVertexCount));
+	meshes.push_back(buildIndexedMesh(milkCPyramidVertices, milkCPyramidVertexCount));
+	meshes.push_back(buildIndexedMesh(donutBoxVertices, donutBoxVertexCount));
+	struct { const char* name; ShapeDesc shape; } shapes[] =
+	{
+		{ "box", boxShape(glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(0.9f, 0.2f, 0.1f)) },
+		{ "plane", planeShape(20.0f, 20.0f, 32, glm::vec3(0.3f, 0.6f, 0.3f)) },
+		{ "cylinder", cylinderShape(0.1f, 2.5f, 16, glm::vec3(1.0f, 1.0f, 1.0f)) },
+		{ "sphere", sphereShape(1.5f, 48, glm::vec3(0.2f, 0.4f, 0.8f)) },
+		{ "torus", torusShape(0.6f, 0.25f, 48, glm::vec3(0.85f, 0.55f, 0.3f)) },
+	};
+	for (const auto& generated : shapes)
+	{
+		for (int lod = 0; lod < demoLodLevels; lod++)
+		{
+			names.push_back(string(generated.name) + " LOD " + to_string(lod));
+			meshes.push_back(generateShape(generated.shape, lod));
+		}
+	}
+
+	for (size_t m = 0; m < meshes.size(); m++)
+	{
+		const IndexedMesh& mesh = meshes[m];
+		QuantizedMesh quantized = quantizeMesh(mesh);
+
+		// Decode every vertex again: positions within one quantization step of the box extent, colors within one RGBA8 step
+		glm::vec3 positionError(0.0f);
+		float colorError = 0.0f;
+		for (GLsizei v = 0; v < mesh.vertexCount(); v++)
+		{
+			const GLfloat* vertex = &mesh.vertices[v * floatsPerVertex];
+			const CompactVertex& packed = quantized.vertices[v];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float decoded = packed.position[axis] / 65535.0f * quantized.dequantScale[axis] + quantized.dequantOffset[axis];
+				positionError[axis] = max(positionError[axis], fabs(decoded - vertex[axis]));
+			}
+			for (int channel = 0; channel < 3; channel++)
+			{
+				colorError = max(colorError, fabs(packed.color[channel] / 255.0f - vertex[3 + channel]));
+			}
+		}
+		size_t floatBytes = mesh.vertices.size() * sizeof(GLfloat);
+		size_t compactBytes = quantized.vertices.size() * sizeof(CompactVertex);
+		cout << names[m] << ": " << mesh.vertexCount() << " vertices, " << floatBytes << " -> " << compactBytes << " bytes, max position error "
+			<< positionError.x << " / " << positionError.y << " / " << positionError.z << ", max color error " << colorError << endl;
+
+		glm::vec3 allowed = quantized.dequantScale / 65535.0f;
+		if (positionError.x > allowed.x || positionError.y > allowed.y || positionError.z > allowed.z)
+		{
+			cout << "FAIL " << names[m] << " position error exceeds the bounding box extent / 65535 (" << allowed.x << " / " << allowed.y << " / " << allowed.z << ")" << endl;
+			failures++;
+		}
+		if (colorError > 1.0f / 255.0f)
+		{
+			cout << "FAIL " << names[m] << " color error exceeds 1/255" << endl;
+			failures++;
+		}
+		if (quantized.vertices.size() != (size_t)mesh.vertexCount() || compactBytes * 2 != floatBytes || quantized.indices != mesh.indices)
+		{
+			cout << "FAIL " << names[m] << " compact vertices are not exactly half the size (" << floatBytes / max(mesh.vertexCount(), 1) << " -> "
+				<< sizeof(CompactVertex) << " bytes per vertex)" << endl;
+			failures++;
+		}
+	}
+
+	cout << (failures == 0 ? "Compact vertex checks passed" : "Compact vertex checks FAILED") << " on " << meshes.size() << " meshes" << endl;
+	return failures == 0 ? 0 : 1;
+}
+
+int runCullBenchmark(int objects, int frames, const char* recording)
+{
+	InputReplay replay;
+	if (recording)
+	{
+		if (!replay.load(recording))
+		{
+			return 1;
+		}
+		frames = (int)replay.tickCount();
+	}
+
+	// CPU only: the pool is filled for its mesh bounds but never uploaded
+	ScenePool pool;
+	int donutBoxId = pool.addMesh(buildIndexedMesh(donutBoxVertices, donutBoxVertexCount));
+
+	// Scatter donut boxes over a square field with a fixed seed so runs are comparable
+	mt19937 random(1234);
+	float fieldSize = sqrt((float)objects) * 4.0f;
+	uniform_real_distribution<float> across(-fieldSize * 0.5f, fieldSize * 0.5f);
+	uniform_real_distribution<float> height(0.0f, 20.0f);
+	Scene scene;
+	vector<AABB> worldBounds(objects);
+	for (int i = 0; i < objects; i++)
+	{
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(across(random), height(random), across(random)));
+		scene.addObject(donutBoxId, model);
+		worldBounds[i] = transformAABB(pool.mesh(donutBoxId).bounds, model);
+	}
+
+	// Fly forward while sweeping the mouse, like a user looking around
+	initCamera();
+	cameraPosition = glm::vec3(0.0f, 10.0f, fieldSize * 0.5f);
+	cameraMovement = 20.0f;
+	const GLfloat frameTime = 1.0f / 60.0f;
+	if (recording)
+	{
+		replay.restoreCamera();
+	}
+
+	double bvhMs = 0.0, bruteMs = 0.0;
+	size_t visibleTotal = 0, mismatches = 0;
+	vector<int> bruteVisible;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		if (recording)
+		{
+			stepCamera(replay.inputForTick(frame));
+		}
+		else
+		{
+			turnCamera(40.0f * sin(frame * 0.02f), 10.0f * cos(frame * 0.05f));
+			moveCamera(MoveForward | (frame % 240 < 120 ? MoveRight : MoveLeft), frameTime);
+		}
+		glm::mat4 viewProjection = computeProjectionMatrix(1280, 720) * computeViewMatrix();
+
+		// First frame includes building the BVH
+		auto start = chrono::high_resolution_clock::now();
+		scene.cull(pool, viewProjection);
+		auto end = chrono::high_resolution_clock::now();
+		bvhMs += chrono::duration<double, milli>(end - start).count();
+
+		// Reference: test every object on its own
+		start = chrono::high_resolution_clock::now();
+		Frustum frustum = extractFrustum(viewProjection);
+		bruteVisible.clear();
+		for (int i = 0; i < objects; i++)
+		{
+			if (testAABB(frustum, worldBounds[i]) != Outside)
+			{
+				bruteVisible.push_back(i);
+			}
+		}
+		end = chrono::high_resolution_clock::now();
+		bruteMs += chrono::duration<double, milli>(end - start).count();
+
+		visibleTotal += scene.visibleCount();
+		if (scene.visibleCount() != bruteVisible.size())
+		{
+			mismatches++;
+		}
+	}
+
+	cout << "Objects: " << objects << ", frames: " << frames << endl;
+	cout << "Visible per frame: " << (double)visibleTotal / frames << " / " << objects << endl;
+	cout << "BVH cull:    " << bvhMs / frames << " ms per frame" << endl;
+	cout << "Brute force: " << bruteMs / frames << " ms per frame" << endl;
+	cout << "Frames where BVH and brute force disagree: " << mismatches << endl;
+	return mismatches == 0 ? 0 : 1;
+}
+
+int runTransformBenchmark(int objects, int iterations)
+{
+	ScenePool pool;
+	int donutBoxId = pool.addMesh(buildIndexedMesh(donutBoxVertices, donutBoxVertexCount));
+	const AABB& bounds = pool.mesh(donutBoxId).bounds;
+
+	// Random placement, rotation and scale with a fixed seed so runs are comparable
+	mt19937 random(1234);
+	float fieldSize = sqrt((float)objects) * 4.0f;
+	uniform_real_distribution<float> across(-fieldSize * 0.5f, fieldSize * 0.5f);
+	uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+	uniform_real_distribution<float> size(0.5f, 2.0f);
+	TransformSoA soa;
+	vector<glm::mat4> reference(objects);
+	for (int i = 0; i < objects; i++)
+	{
+		glm::vec3 position(across(random), unit(random) * 10.0f, across(random));
+		glm::vec3 axis(unit(random), unit(random), unit(random) + 2.0f);		// Keep the axis away from zero length
+		float a = angle(random);
+		glm::vec3 scale(size(random), size(random), size(random));
+		soa.add(position, axis, a, scale, bounds);
+		reference[i] = glm::scale(glm::rotate(glm::translate(glm::mat4(1.0f), position), a, axis), scale);
+	}
+
+	// Camera looking over the field
+	initCamera();
+	cameraPosition = glm::vec3(0.0f, 10.0f, fieldSize * 0.5f);
+	Frustum frustum = extractFrustum(computeProjectionMatrix(1280, 720) * computeViewMatrix());
+
+	vector<unsigned char> referenceVisible(objects);
+	for (int i = 0; i < objects; i++)
+	{
+		referenceVisible[i] = testAABB(frustum, transformAABB(bounds, reference[i])) != Outside;
+	}
+
+	cout << "Objects: " << objects << ", iterations: " << iterations << endl;
+	cout << "Best path on this CPU: " << kernelPathName(detectKernelPath()) << endl;
+
+	vector<glm::mat4> world(objects);
+	vector<unsigned char> visible(objects);
+	int failures = 0;
+	for (int path = ScalarKernel; path <= detectKernelPath(); path++)
+	{
+		auto start = chrono::high_resolution_clock::now();
+		for (int n = 0; n < iterations; n++)
+		{
+			transformAndCull((KernelPath)path, soa, frustum, world.data(), visible.data());
+		}
+		auto end = chrono::high_resolution_clock::now();
+		double ms = chrono::duration<double, milli>(end - start).count() / iterations;
+
+		// Matrices must match glm within float rounding; visibility may only differ for boxes touching a plane
+		float maxError = 0.0f;
+		int visibleCount = 0, disagreements = 0;
+		for (int i = 0; i < objects; i++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				glm::vec4 difference = glm::abs(world[i][column] - reference[i][column]);
+				maxError = max(maxError, max(max(difference.x, difference.y), max(difference.z, difference.w)));
+			}
+			visibleCount += visible[i];
+			disagreements += visible[i] != referenceVisible[i];
+		}
+
+		cout << kernelPathName((KernelPath)path) << ": " << ms << " ms per pass, " << objects / ms << " objects per ms, "
+			<< visibleCount << " visible, max matrix error " << maxError << ", visibility disagreements " << disagreements << endl;
+		if (maxError > 1e-3f || disagreements > objects / 1000)
+		{
+			failures++;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+// Scripted input for one simulation tick: cycles through movement keys while sweeping the mouse
+static CameraInput scriptedInput(long long tick)
+{
+	static const unsigned int keyPattern[] = { MoveForward, MoveForward | MoveRight, MoveBackward | MoveUp, MoveLeft, MoveForward | MoveDown, 0 };
+	CameraInput input;
+	input.keys = keyPattern[(tick / 90) % 6];
+	input.xTurn = 3.0f * (float)sin(tick * 0.05);
+	input.yTurn = 1.5f * (float)cos(tick * 0.031);
+	if (tick % 200 == 100)
+	{
+		input.scroll = tick % 400 == 100 ? -2.0f : 1.0f;
+	}
+	if (tick == 1000)
+	{
+		input.keys |= ResetCamera;
+	}
+	return input;
+}
+
+static void resetCameraForReplay()
+{
+	initCamera();
+	yaw = -90.0f;
+	pitch = 0.0f;
+	cameraMovement = 10.0f;
+}
+
+// Scripted session on the wall clock, delivered as events the way the window system does. 'W' is held for the
+// first half; in the second half the cursor sweeps right (reported at 500 Hz) until 90% of the session and four
+// scroll clicks speed the camera up. Keys are sampled once per frame, like glfwGetKey() in processInput().
+static const double cursorReportPeriod = 0.002;
+
+static float scriptedCursorX(double time, double seconds)
+{
+	double rate = 3000.0 / seconds;		// Pixels per second; 120 degrees of yaw in total
+	return (float)(rate * (min(max(time, seconds * 0.5), seconds * 0.9) - seconds * 0.5));
+}
+
+// Add the events of the wall time (from, to] to the input waiting for the next tick, as the callbacks do
+static void gatherScriptedInput(CameraInput& pending, double from, double to, double seconds)
+{
+	for (long long report = (long long)floor(from / cursorReportPeriod) + 1; report * cursorReportPeriod <= to; report++)
+	{
+		double time = report * cursorReportPeriod;
+		pending.xTurn += scriptedCursorX(time, seconds) - scriptedCursorX(time - cursorReportPeriod, seconds);
+	}
+	for (int click = 1; click <= 4; click++)
+	{
+		double time = seconds * (0.5 + click * 0.1);
+		if (time > from && time <= to)
+		{
+			pending.scroll -= 1.0f;
+		}
+	}
+	pending.keys = to < seconds * 0.5 ? MoveForward : 0;
+}
+
+int runTimestepReplayTest(double seconds)
+{
+	const char* names[] = { "30 Hz", "60 Hz", "144 Hz", "240 Hz", "jittered 1-40 ms", "stalls of 400 ms" };
+	const int runs = 6;
+	const double maxFrameTime = 0.25;		// FixedTimestep's default clamp
+
+	int failures = 0;
+	for (int run = 0; run < runs; run++)
+	{
+		mt19937 random(99);
+		uniform_real_distribution<double> jitter(0.001, 0.040);
+
+		resetCameraForReplay();
+		const glm::vec3 start = cameraPosition;
+		const glm::vec3 startFront = cameraFront;
+		const float startYaw = yaw, startSpeed = cameraMovement;
+
+		FixedTimestep simulation(simulationStep, maxFrameTime);
+		CameraInput pending;
+		CameraState previous = captureCameraState(), current = previous;
+		double wall = 0.0, lostTime = 0.0, longestFrame = 0.0;
+		int frames = 0;
+		float lastForward = 0.0f, lastYaw = startYaw;
+		bool alphaInRange = true, steppedBack = false, overshot = false, turnedBack = false;
+		while (wall < seconds)
+		{
+			double frameTime;
+			switch (run)
+			{
+			case 0: frameTime = 1.0 / 30.0; break;
+			case 1: frameTime = 1.0 / 60.0; break;
+			case 2: frameTime = 1.0 / 144.0; break;
+			case 3: frameTime = 1.0 / 240.0; break;
+			case 4: frameTime = jitter(random); break;
+			default: frameTime = frames % 50 == 49 ? 0.4 : 1.0 / 60.0; break;
+			}
+			frames++;
+
+			// Events that arrived since the last frame, then the ticks this frame covers; cursor and scroll go to the first
+			gatherScriptedInput(pending, wall, wall + frameTime, seconds);
+			if (wall < seconds * 0.5)
+			{
+				lostTime += max(frameTime - maxFrameTime, 0.0);		// Stalls are clamped; that time is never simulated
+			}
+			wall += frameTime;
+			longestFrame = max(longestFrame, min(frameTime, maxFrameTime));
+			int ticks = simulation.advance(frameTime);
+			for (int tick = 0; tick < ticks; tick++)
+			{
+				previous = current;
+				stepCamera(pending);
+				current = captureCameraState();
+				pending.xTurn = pending.yTurn = pending.scroll = 0.0f;
+			}
+
+			// What the renderer draws this frame: never behind the last frame, never ahead of the latest tick
+			float alpha = simulation.alpha();
+			alphaInRange = alphaInRange && alpha >= 0.0f && alpha < 1.0f;
+			CameraState render = interpolateCameraState(previous, current, alpha);
+			float forward = glm::dot(render.position - start, startFront);
+			steppedBack = steppedBack || forward < lastForward - 1e-4f;
+			overshot = overshot || forward > glm::dot(current.position - start, startFront) + 1e-4f;
+			float renderYaw = glm::degrees(atan2(render.front.z, render.front.x));
+			turnedBack = turnedBack || renderYaw < lastYaw - 1e-3f;
+			lastForward = forward;
+			lastYaw = renderYaw;
+		}
+
+		// Input still waiting for a tick goes to the next one
+		stepCamera(pending);
+
+		// The key was held for half the session minus clamped stall time, give or take the frame that samples its release
+		float distance = glm::dot(cameraPosition - start, startFront);
+		float expectedDistance = (float)(startSpeed * (seconds * 0.5 - lostTime));
+		float distanceTolerance = (float)(startSpeed * (longestFrame + simulationStep));
+		float expectedYaw = startYaw + 0.1f * scriptedCursorX(seconds, seconds);
+		float expectedSpeed = startSpeed + 4.0f;
+
+		cout << names[run] << ": " << frames << " frames, " << simulation.ticks() << " ticks, moved " << distance << " (expected " << expectedDistance
+			<< " +- " << distanceTolerance << "), yaw " << yaw << " (expected " << expectedYaw << "), speed " << cameraMovement;
+		bool ok = true;
+		if (fabs(distance - expectedDistance) > distanceTolerance)
+		{
+			cout << ", DISTANCE off";
+			ok = false;
+		}
+		if (fabs(yaw - expectedYaw) > 0.01f)
+		{
+			cout << ", CURSOR input lost or repeated";
+			ok = false;
+		}
+		if (cameraMovement != expectedSpeed)
+		{
+			cout << ", SCROLL input lost or repeated";
+			ok = false;
+		}
+		if (steppedBack || overshot)
+		{
+			cout << (steppedBack ? ", render pose STEPPED BACK" : ", render pose AHEAD of the latest tick");
+			ok = false;
+		}
+		if (turnedBack)
+		{
+			cout << ", render yaw TURNED BACK";
+			ok = false;
+		}
+		if (!alphaInRange)
+		{
+			cout << ", interpolation factor out of range";
+			ok = false;
+		}
+		cout << endl;
+		failures += ok ? 0 : 1;
+	}
+
+	// For comparison: the old per-frame update with the variable frame delta
+	cout << "Variable timestep final positions:";
+	const double rates[] = { 30.0, 60.0, 144.0, 240.0 };
+	for (double rate : rates)
+	{
+		resetCameraForReplay();
+		long long framesToRun = (long long)(seconds * rate);
+		for (long long frame = 0; frame < framesToRun; frame++)
+		{
+			CameraInput input = scriptedInput((long long)(frame / rate / simulationStep));
+			turnCamera(input.xTurn * (GLfloat)(120.0 / rate), input.yTurn * (GLfloat)(120.0 / rate));
+			moveCamera(input.keys & ~ResetCamera, (GLfloat)(1.0 / rate));
+		}
+		cout << " " << rate << " Hz (" << cameraPosition.x << ", " << cameraPosition.y << ", " << cameraPosition.z << ")";
+	}
+	cout << endl;
+
+	cout << (failures == 0 ? "Fixed timestep camera consistent at every frame rate" : "Fixed timestep camera checks FAILED") << endl;
+	return failures == 0 ? 0 : 1;
+}
+
+// FNV-1a over the raw bits of the camera after every tick
+static unsigned long long hashCameraState(unsigned long long hash, const CameraState& state)
+{
+	const float values[6] = { state.position.x, state.position.y, state.position.z, state.front.x, state.front.y, state.front.z };
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+	for (size_t i = 0; i < sizeof(values); i++)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+int runInputReplay(const char* path)
+{
+	InputReplay replay;
+	if (!replay.load(path))
+	{
+		return 1;
+	}
+	cout << "Recording: " << replay.tickCount() << " ticks (" << replay.tickCount() * simulationStep << " s), "
+		<< replay.recordCount() << " input records" << endl;
+
+	unsigned long long hashes[2];
+	CameraState finalState;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		replay.rewind();
+		replay.restoreCamera();
+		unsigned long long hash = 14695981039346656037ULL;
+		for (long long tick = 0; tick < replay.tickCount(); tick++)
+		{
+			stepCamera(replay.inputForTick(tick));
+			hash = hashCameraState(hash, captureCameraState());
+		}
+		hashes[pass] = hash;
+		finalState = captureCameraState();
+	}
+
+	cout << "Final camera position (" << finalState.position.x << ", " << finalState.position.y << ", " << finalState.position.z
+		<< "), yaw " << yaw << ", pitch " << pitch << ", speed " << cameraMovement << endl;
+	cout << "Trajectory hash: " << hex << hashes[0] << dec << endl;
+	if (hashes[0] != hashes[1])
+	{
+		cout << "Replay passes differ" << endl;
+		return 1;
+	}
+	return 0;
+}
+
+// Nearest-rank percentile of an ascending list
+static double percentile(const vector<double>& sorted, double p)
+{
+	size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+	return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+// Copy a GL string into a JSON string literal
+static string jsonString(const char* text)
+{
+	string out = "\"";
+	for (const char* c = text ? text : ""; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			out += '\\';
+		}
+		if ((unsigned char)*c >= 0x20)
+		{
+			out += *c;
+		}
+	}
+	return out + "\"";
+}
+
+int runFrameBenchmark(int frames, int donutBoxes, const char* jsonPath)
+{
+	const int targetWidth = 1280, targetHeight = 720;
+	GLFWwindow* window = createOffscreenContext(64, 64);
+	if (!window)
+	{
+		return -1;
+	}
+
+	Framebuffer target;
+	if (!target.create(targetWidth, targetHeight))
+	{
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return -1;
+	}
+
+	// Same scene and shaders as the interactive app
+	ScenePool pool;
+	DemoMeshes meshes = addDemoMeshes(pool, false);
+	pool.upload();
+	Scene scene;
+	populateDemoScene(scene, pool, meshes, donutBoxes);
+
+	glEnable(GL_DEPTH_TEST);
+	GLuint shaderProgram = CreateShaderProgram(vertexShaderSource, fragmentShaderSource);
+	BindCameraBlock(shaderProgram);
+	RenderState renderState;
+	RenderCamera camera;
+	camera.setViewport(targetWidth, targetHeight);
+	CameraUniformBuffer cameraBuffer;
+	cameraBuffer.create();
+
+	// Scripted flythrough at a fixed 60 frames per second of simulated time, two camera ticks per frame
+	resetCameraForReplay();
+	target.bind();
+	vector<double> frameMs(frames);
+	double submitMs = 0.0;
+	size_t drawCalls = 0, triangles = 0;
+	double streamedBytes = 0.0, fenceWaitMs = 0.0;
+	size_t unsortedChanges = 0, sortedChanges = 0;
+	unsigned long long steadyAllocations = 0;		// From the second half on, once buffers have grown
+	long long tick = 0;
+	auto runStart = chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		auto start = chrono::high_resolution_clock::now();
+		unsigned long long allocationsBefore = heapAllocationCount();
+		renderState.beginFrame();
+		for (int t = 0; t < 2; t++)
+		{
+			stepCamera(scriptedInput(tick++));
+		}
+		animateDemoScene(scene, frame / 60.0f);
+
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		renderState.useProgram(shaderProgram);
+		camera.setPose(cameraPosition, cameraFront, cameraUp);
+		camera.setLens(fov, perspective);
+		cameraBuffer.update(camera.view(), camera.projection());
+		scene.cull(pool, camera.viewProjection());
+		scene.setLodView(cameraPosition, fov);
+		scene.buildInstances(pool);
+		pool.uploadInstances(scene.instanceTransforms().data(), scene.instanceTransforms().size());
+		pool.draw(renderState, scene.drawBatches().data(), scene.drawBatches().size());
+		// Stream counters are final once the next frame begins, so these belong to the previous frame
+		streamedBytes += pool.streamStats().bytesUploaded;
+		fenceWaitMs += pool.streamStats().fenceWaitMs;
+		auto submitted = chrono::high_resolution_clock::now();
+
+		// Wait for the frame so its cost is not pushed into later frames
+		glFinish();
+		auto end = chrono::high_resolution_clock::now();
+		if (frame >= frames / 2)
+		{
+			steadyAllocations += heapAllocationCount() - allocationsBefore;
+		}
+
+		frameMs[frame] = chrono::duration<double, milli>(end - start).count();
+		submitMs += chrono::duration<double, milli>(submitted - start).count();
+		drawCalls += pool.stats().drawCalls;
+		unsortedChanges += scene.sortStats().unsortedChanges;
+		sortedChanges += scene.sortStats().sortedChanges;
+		for (const DrawBatch& batch : scene.drawBatches())
+		{
+			triangles += (size_t)pool.mesh(batch.mesh).indexCount / 3 * batch.instanceCount;
+		}
+	}
+	double totalSeconds = chrono::duration<double>(chrono::high_resolution_clock::now() - runStart).count();
+
+	vector<double> sorted = frameMs;
+	sort(sorted.begin(), sorted.end());
+	double meanMs = 0.0;
+	for (double ms : frameMs)
+	{
+		meanMs += ms;
+	}
+	meanMs /= frames;
+
+	ostringstream json;
+	json << "{" << endl
+		<< "  \"benchmark\": \"frames\"," << endl
+		<< "  \"renderer\": " << jsonString((const char*)glGetString(GL_RENDERER)) << "," << endl
+		<< "  \"width\": " << targetWidth << "," << endl
+		<< "  \"height\": " << targetHeight << "," << endl
+		<< "  \"frames\": " << frames << "," << endl
+		<< "  \"objects\": " << scene.objectCount() << "," << endl
+		<< "  \"frame_ms\": { \"mean\": " << meanMs << ", \"p50\": " << percentile(sorted, 50.0) << ", \"p95\": " << percentile(sorted, 95.0)
+		<< ", \"p99\": " << percentile(sorted, 99.0) << ", \"max\": " << sorted.back() << " }," << endl
+		<< "  \"submit_ms_mean\": " << submitMs / frames << "," << endl
+		<< "  \"frames_per_second\": " << frames / totalSeconds << "," << endl
+		<< "  \"camera_uploads\": " << cameraBuffer.uploads() << "," << endl
+		<< "  \"draw_calls_per_frame\": " << (double)drawCalls / frames << "," << endl
+		<< "  \"state_changes_unsorted_per_frame\": " << (double)unsortedChanges / frames << "," << endl
+		<< "  \"state_changes_sorted_per_frame\": " << (double)sortedChanges / frames << "," << endl
+		<< "  \"stream_bytes_per_frame\": " << streamedBytes / (frames > 1 ? frames - 1 : 1) << "," << endl
+		<< "  \"fence_wait_ms_total\": " << fenceWaitMs << "," << endl
+		<< "  \"heap_allocations_per_frame\": " << (double)steadyAllocations / (frames - frames / 2) << "," << endl
+		<< "  \"triangles_per_frame\": " << (double)triangles / frames << "," << endl
+		<< "  \"triangles_per_second\": " << triangles / totalSeconds << endl
+		<< "}" << endl;
+
+	if (jsonPath)
+	{
+		ofstream file(jsonPath);
+		file << json.str();
+		cout << "Wrote " << jsonPath << endl;
+	}
+	else
+	{
+		cout << json.str();
+	}
+
+	// Release GPU resources
+	renderState.invalidate();
+	pool.destroy();
+	cameraBuffer.destroy();
+	glDeleteProgram(shaderProgram);
+	target.destroy();
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
+
+int runShaderBenchmark(int programs)
+{
+	GLFWwindow* window = createOffscreenContext(64, 64);
+	if (!window)
+	{
+		return -1;
+	}
+
+	// Every variant gets its own define so neither this cache nor the driver's own cache has seen it
+	const string directory = "shadercache_bench";
+	string runTag = to_string(chrono::steady_clock::now().time_since_epoch().count());
+	auto variantDefines = [&](const char* pass, int i)
+	{
+		return "#define ALMOND_VARIANT_" + string(pass) + "_" + to_string(i) + "_" + runTag;
+	};
+	auto elapsedMs = [](chrono::high_resolution_clock::time_point start)
+	{
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	};
+
+	int failures = 0;
+
+	// Cold, one by one: request and wait for each program before the next
+	ShaderCache cold(directory);
+	auto start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < programs; i++)
+	{
+		failures += cold.program(cold.request(vertexShaderSource, fragmentShaderSource, variantDefines("serial", i))) == 0;
+	}
+	double coldMs = elapsedMs(start);
+
+	// Cold, batched: request every program first, then collect them
+	ShaderCache batched(directory);
+	vector<int> handles(programs);
+	start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < programs; i++)
+	{
+		handles[i] = batched.request(vertexShaderSource, fragmentShaderSource, variantDefines("batched", i));
+	}
+	for (int handle : handles)
+	{
+		failures += batched.program(handle) == 0;
+	}
+	double batchedMs = elapsedMs(start);
+
+	// Warm: a fresh cache finds the binaries the serial pass stored
+	ShaderCache warm(directory);
+	start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < programs; i++)
+	{
+		failures += warm.program(warm.request(vertexShaderSource, fragmentShaderSource, variantDefines("serial", i))) == 0;
+	}
+	double warmMs = elapsedMs(start);
+
+	cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+	cout << "Program binaries: " << (warm.binariesSupported() ? "supported" : "not supported")
+		<< ", parallel compile: " << (batched.parallelCompile() ? "supported" : "not supported") << endl;
+	cout << "Cold, one at a time: " << coldMs / programs << " ms per program" << endl;
+	cout << "Cold, batched:       " << batchedMs / programs << " ms per program" << endl;
+	cout << "Warm (binary cache): " << warmMs / programs << " ms per program (" << warm.stats().binaryHits << " of " << programs
+		<< " loaded from binary, " << warm.stats().binaryRejected << " rejected)" << endl;
+
+	cold.eraseBinaries();
+	batched.eraseBinaries();
+	cold.destroy();
+	batched.destroy();
+	warm.destroy();
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return failures == 0 ? 0 : 1;
+}
+
+// Square grid of quads with vertex colors, written as OBJ text
+static bool writeGridObj(const string& path, int quadsPerSide)
+{
+	ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+	int side = quadsPerSide + 1;
+	for (int z = 0; z < side; z++)
+	{
+		for (int x = 0; x < side; x++)
+		{
+			file << "v " << x * 0.1f << " " << sin(x * 0.05f) * cos(z * 0.05f) << " " << z * 0.1f << " "
+				<< (float)x / side << " " << (float)z / side << " 0.5" << "\n";
+		}
+	}
+	for (int z = 0; z < quadsPerSide; z++)
+	{
+		for (int x = 0; x < quadsPerSide; x++)
+		{
+			int corner = z * side + x + 1;
+			file << "f " << corner << " " << corner + side << " " << corner + side + 1 << " " << corner + 1 << "\n";
+		}
+	}
+	return (bool)file;
+}
+
+int runSceneLoadBenchmark(const char* objPath, int iterations)
+{
+	GLFWwindow* window = createOffscreenContext(64, 64);
+	if (!window)
+	{
+		return -1;
+	}
+
+	string source = objPath ? objPath : "scene_load_bench.obj";
+	string converted = "scene_load_bench.amsc";
+	if (!objPath)
+	{
+		cout << "Writing " << source << " (about one million triangles)" << endl;
+		writeGridObj(source, 708);
+	}
+	if (convertScene(converted, vector<string>(1, source), false) != 0)
+	{
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return 1;
+	}
+
+	// Both paths end with the geometry on the GPU; glFinish makes sure the upload is really done
+	double textMs = 0.0, mappedMs = 0.0;
+	GLsizei textIndices = 0, mappedIndices = 0;
+	size_t mappedBytes = 0;
+	for (int i = 0; i < iterations; i++)
+	{
+		auto start = chrono::high_resolution_clock::now();
+		IndexedMesh mesh;
+		loadObjMesh(source, mesh);
+		ScenePool textPool;
+		textPool.addMesh(mesh);
+		textPool.upload();
+		glFinish();
+		textMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+		textIndices = textPool.mesh(0).indexCount;
+		textPool.destroy();
+
+		start = chrono::high_resolution_clock::now();
+		SceneFile file;
+		ScenePool mappedPool;
+		if (file.open(converted))
+		{
+			mappedPool.uploadFromFile(file);
+			mappedBytes = file.fileSize();
+			file.close();
+		}
+		glFinish();
+		mappedMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+		mappedIndices = mappedPool.meshCount() > 0 ? mappedPool.mesh(0).indexCount : 0;
+		mappedPool.destroy();
+	}
+
+	cout << "Triangles: " << textIndices / 3 << ", scene file: " << mappedBytes / (1024.0 * 1024.0) << " MB" << endl;
+	cout << "OBJ text parse + upload:   " << textMs / iterations << " ms" << endl;
+	cout << "Mapped scene file upload:  " << mappedMs / iterations << " ms" << endl;
+
+	remove(converted.c_str());
+	if (!objPath)
+	{
+		remove(source.c_str());
+	}
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return textIndices == mappedIndices ? 0 : 1;
+}
+
+// Volume enclosed by a closed mesh; positive when its faces point outward
+static double signedVolume(const IndexedMesh& mesh)
+{
+	double volume = 0.0;
+	for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+	{
+		glm::vec3 a(mesh.vertices[mesh.indices[t] * floatsPerVertex], mesh.vertices[mesh.indices[t] * floatsPerVertex + 1], mesh.vertices[mesh.indices[t] * floatsPerVertex + 2]);
+		glm::vec3 b(mesh.vertices[mesh.indices[t + 1] * floatsPerVertex], mesh.vertices[mesh.indices[t + 1] * floatsPerVertex + 1], mesh.vertices[mesh.indices[t + 1] * floatsPerVertex + 2]);
+		glm::vec3 c(mesh.vertices[mesh.indices[t + 2] * floatsPerVertex], mesh.vertices[mesh.indices[t + 2] * floatsPerVertex + 1], mesh.vertices[mesh.indices[t + 2] * floatsPerVertex + 2]);
+		volume += glm::dot(a, glm::cross(b, c)) / 6.0;
+	}
+	return volume;
+}
+
+int runMeshGeneratorTest(int shapes)
+{
+	const float pi = 3.14159265358979f;
+	int failures = 0;
+
+	// Vertex and triangle counts against the closed-form counts of each shape
+	const int segmentCounts[] = { 3, 4, 8, 16, 33, 64 };
+	for (int n : segmentCounts)
+	{
+		// Cylinders and spheres are clamped to their minimum segment counts
+		int c = max(n, 3), s = max(n, 4), bands = max(s / 2, 2), sides = max(n / 2, 3);
+		struct { const char* name; ShapeDesc shape; int vertices, triangles; } cases[] =
+		{
+			{ "box", boxShape(glm::vec3(1.0f), glm::vec3(1.0f)), 8, 12 },
+			{ "plane", planeShape(1.0f, 1.0f, n, glm::vec3(1.0f)), (n + 1) * (n + 1), 2 * n * n },
+			{ "cylinder", cylinderShape(1.0f, 1.0f, c, glm::vec3(1.0f)), 2 * c + 2, 4 * c },
+			{ "sphere", sphereShape(1.0f, s, glm::vec3(1.0f)), (bands - 1) * s + 2, 2 * s * (bands - 1) },
+			{ "torus", torusShape(1.0f, 0.25f, n, glm::vec3(1.0f)), n * sides, 2 * n * sides },
+		};
+		for (const auto& test : cases)
+		{
+			IndexedMesh mesh = generateShape(test.shape);
+			if (mesh.vertexCount() != test.vertices || mesh.indexCount() != test.triangles * 3)
+			{
+				cout << "FAIL " << test.name << " with " << n << " segments: " << mesh.vertexCount() << " vertices, " << mesh.indexCount() / 3
+					<< " triangles, expected " << test.vertices << " and " << test.triangles << endl;
+				failures++;
+			}
+		}
+	}
+	cout << "Vertex counts checked for " << sizeof(segmentCounts) / sizeof(segmentCounts[0]) << " tessellations of every shape" << endl;
+
+	// Closed shapes have no open edges at any level and enclose close to their analytic volume at full detail
+	const int levels = 5;
+	struct { const char* name; ShapeDesc shape; double volume; } closed[] =
+	{
+		{ "box", boxShape(glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(1.0f)), 6.0 },
+		{ "cylinder", cylinderShape(1.0f, 2.0f, 64, glm::vec3(1.0f)), pi * 2.0 },
+		{ "sphere", sphereShape(1.0f, 64, glm::vec3(1.0f)), 4.0 / 3.0 * pi },
+		{ "torus", torusShape(1.0f, 0.25f, 64, glm::vec3(1.0f)), 2.0 * pi * pi * 1.0 * 0.25 * 0.25 },
+	};
+	for (const auto& test : closed)
+	{
+		cout << test.name << ":";
+		for (int lod = 0; lod < levels; lod++)
+		{
+			IndexedMesh mesh = generateShape(test.shape, lod);
+			size_t open = countOpenEdges(mesh);
+			double volume = signedVolume(mesh);
+			cout << " LOD " << lod << " " << mesh.indexCount() / 3 << " tris";
+			if (open != 0 || volume <= 0.0)
+			{
+				cout << " (FAIL: " << open << " open edges, volume " << volume << ")";
+				failures++;
+			}
+			if (lod == 0 && fabs(volume - test.volume) > test.volume * 0.05)
+			{
+				cout << " (FAIL: volume " << volume << ", expected " << test.volume << ")";
+				failures++;
+			}
+		}
+		cout << endl;
+	}
+	for (int n : segmentCounts)
+	{
+		// A plane is open along its border only
+		size_t open = countOpenEdges(generateShape(planeShape(1.0f, 1.0f, n, glm::vec3(1.0f))));
+		if (open != (size_t)(4 * n))
+		{
+			cout << "FAIL plane with " << n << " subdivisions: " << open << " open edges, expected " << 4 * n << endl;
+			failures++;
+		}
+	}
+	cout << "Watertightness checked" << endl;
+
+	// Level i is used while the projected size is at least lodFullDetailSize / 2^i
+	const float radius = 1.0f, fovDegrees = 45.0f;
+	const int lodLevels = 4;
+	for (int lod = 0; lod < lodLevels - 1; lod++)
+	{
+		float threshold = lodFullDetailSize / (float)(1 << lod);
+		float distance = radius / (threshold * tan(glm::radians(fovDegrees) * 0.5f));
+		int nearer = selectLod(radius, distance * 0.99f, fovDegrees, lodLevels);
+		int farther = selectLod(radius, distance * 1.01f, fovDegrees, lodLevels);
+		cout << "Switch to LOD " << lod + 1 << " at distance " << distance << ": " << nearer << " -> " << farther << endl;
+		if (nearer != lod || farther != lod + 1)
+		{
+			cout << "FAIL LOD threshold " << lod << endl;
+			failures++;
+		}
+	}
+	int previous = 0;
+	for (float distance = 0.5f; distance < 1000.0f; distance *= 1.05f)
+	{
+		int lod = selectLod(radius, distance, fovDegrees, lodLevels);
+		if (lod < previous || lod >= lodLevels)
+		{
+			cout << "FAIL LOD " << lod << " at distance " << distance << " after LOD " << previous << endl;
+			failures++;
+		}
+		previous = lod;
+	}
+	if (previous != lodLevels - 1 || selectLod(radius, 0.5f, fovDegrees, lodLevels) != 0 || selectLod(radius, 1000.0f, 0.0f, lodLevels) != 0)
+	{
+		cout << "FAIL LOD selection at the extremes" << endl;
+		failures++;
+	}
+
+	// Parallel generation of a large batch gives the same meshes as generating them on one thread
+	vector<ShapeDesc> batch;
+	vector<int> lods;
+	mt19937 random(7);
+	uniform_int_distribution<int> type(0, 4), segments(32, 96);
+	for (int i = 0; i < shapes; i++)
+	{
+		ShapeDesc shape;
+		switch (type(random))
+		{
+		case 0: shape = boxShape(glm::vec3(1.0f), glm::vec3(1.0f)); break;
+		case 1: shape = planeShape(1.0f, 1.0f, segments(random), glm::vec3(1.0f)); break;
+		case 2: shape = cylinderShape(1.0f, 1.0f, segments(random), glm::vec3(1.0f)); break;
+		case 3: shape = sphereShape(1.0f, segments(random), glm::vec3(1.0f)); break;
+		default: shape = torusShape(1.0f, 0.25f, segments(random), glm::vec3(1.0f)); break;
+		}
+		batch.push_back(shape);
+		lods.push_back(i % 3);
+	}
+	auto start = chrono::high_resolution_clock::now();
+	vector<IndexedMesh> serial = generateShapes(batch, lods, 1);
+	auto serialEnd = chrono::high_resolution_clock::now();
+	vector<IndexedMesh> parallel = generateShapes(batch, lods);
+	auto parallelEnd = chrono::high_resolution_clock::now();
+	double serialMs = chrono::duration<double, milli>(serialEnd - start).count();
+	double parallelMs = chrono::duration<double, milli>(parallelEnd - serialEnd).count();
+
+	size_t mismatches = 0, triangles = 0;
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		mismatches += serial[i].vertices != parallel[i].vertices || serial[i].indices != parallel[i].indices;
+		triangles += serial[i].indices.size() / 3;
+	}
+	cout << "Generated " << shapes << " shapes (" << triangles << " triangles): " << serialMs << " ms on 1 thread, " << parallelMs << " ms on "
+		<< max(thread::hardware_concurrency(), 1u) << " threads (" << serialMs / parallelMs << "x)" << endl;
+	if (mismatches != 0)
+	{
+		cout << "FAIL " << mismatches << " shapes differ between serial and parallel generation" << endl;
+		failures++;
+	}
+
+	cout << (failures == 0 ? "Mesh generator checks passed" : "Mesh generator checks FAILED") << endl;
+	return failures == 0 ? 0 : 1;
+}
+
+// Order-independent fingerprint of a draw list: batches exactly, and per batch the sum of a hash of every matrix
+static vector<unsigned long long> drawListFingerprint(const DrawList& list)
+{
+	vector<unsigned long long> fingerprint;
+	for (const DrawBatch& batch : list.batches)
+	{
+		unsigned long long sum = 0;
+		for (GLsizei i = 0; i < batch.instanceCount; i++)
+		{
+			const unsigned int* bits = (const unsigned int*)&list.transforms[batch.firstInstance + i];
+			unsigned long long hash = 1469598103934665603ull;		// FNV-1a over the matrix bits
+			for (int e = 0; e < 16; e++)
+			{
+				hash = (hash ^ bits[e]) * 1099511628211ull;
+			}
+			sum += hash;
+		}
+		fingerprint.push_back((unsigned long long)batch.mesh);
+		fingerprint.push_back(batch.firstInstance);
+		fingerprint.push_back((unsigned long long)batch.instanceCount);
+		fingerprint.push_back(sum);
+	}
+	return fingerprint;
+}
+
+// Start of the camera path shared by every run of the scaling benchmark
+static void resetScalingCamera(float fieldSize)
+{
+	resetCameraForReplay();
+	cameraPosition = glm::vec3(0.0f, 10.0f, fieldSize * 0.5f);
+	cameraMovement = 20.0f;
+}
+
+// Camera path shared by every run of the scaling benchmark
+static void flyScalingCamera(int frame)
+{
+	turnCamera(40.0f * sin(frame * 0.02f), 10.0f * cos(frame * 0.05f));
+	moveCamera(MoveForward | (frame % 240 < 120 ? MoveRight : MoveLeft), 1.0f / 60.0f);
+}
+
+// Synthetic scene of 'objects' objects scattered over a square field: half static objects in the BVH (donut boxes
+// and LOD donuts), half spinning donut boxes. CPU only: the pool is filled for its mesh bounds but never uploaded.
+// Returns the field size.
+static float buildSyntheticScene(ScenePool& pool, Scene& scene, int objects, LodChain& donutChain)
+{
+	int donutBoxId = pool.addMesh(buildIndexedMesh(donutBoxVertices, donutBoxVertexCount));
+	donutChain = addLodChains(pool, vector<ShapeDesc>(1, torusShape(0.6f, 0.25f, 48, glm::vec3(0.85f, 0.55f, 0.3f))), demoLodLevels)[0];
+
+	mt19937 random(1234);
+	float fieldSize = sqrt((float)objects) * 4.0f;
+	uniform_real_distribution<float> across(-fieldSize * 0.5f, fieldSize * 0.5f);
+	uniform_real_distribution<float> height(0.0f, 20.0f);
+	int donut = scene.addLodChain(donutChain);
+	for (int i = 0; i < objects; i++)
+	{
+		glm::vec3 position(across(random), height(random), across(random));
+		if (i % 2 == 0)
+		{
+			scene.addDynamicObject(pool, donutBoxId, position, glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, glm::vec3(1.0f));
+		}
+		else if (i % 4 == 1)
+		{
+			scene.addObject(donutBoxId, glm::translate(glm::mat4(1.0f), position));
+		}
+		else
+		{
+			scene.addLodObject(donut, glm::translate(glm::mat4(1.0f), position));
+		}
+	}
+	return fieldSize;
+}
+
+int runThreadScalingBenchmark(int objects, int frames)
+{
+	ScenePool pool;
+	Scene scene;
+	LodChain donutChain;
+	float fieldSize = buildSyntheticScene(pool, scene, objects, donutChain);
+	cout << "Objects: " << objects << " (" << scene.dynamicTransforms().size() << " spinning), frames: " << frames << endl;
+
+	// Reference lists built on this thread alone
+	vector<vector<unsigned long long>> reference(frames);
+	resetScalingCamera(fieldSize);
+	DrawList list;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		flyScalingCamera(frame);
+		animateDemoScene(scene, frame / 60.0f);
+		scene.setLodView(cameraPosition, fov);
+		scene.cull(pool, computeProjectionMatrix(1280, 720) * computeViewMatrix());
+		scene.buildInstances(pool, list);
+		reference[frame] = drawListFingerprint(list);
+	}
+
+	// 1, 2, 4, ... threads up to one per core
+	unsigned int cores = max(thread::hardware_concurrency(), 1u);
+	vector<unsigned int> threadCounts;
+	for (unsigned int threads = 1; threads < cores; threads *= 2)
+	{
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(cores);
+
+	int failures = 0;
+	double singleThreadMs = 0.0;
+	vector<glm::mat4> submitted;
+	for (unsigned int threads : threadCounts)
+	{
+		JobSystem jobs(threads);
+
+		// Producer stage only: cull and build every frame's list, checked against the reference
+		resetScalingCamera(fieldSize);
+		double buildMs = 0.0;
+		int mismatches = 0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			flyScalingCamera(frame);
+			animateDemoScene(scene, frame / 60.0f);
+			scene.setLodView(cameraPosition, fov);
+			auto start = chrono::high_resolution_clock::now();
+			scene.cull(pool, computeProjectionMatrix(1280, 720) * computeViewMatrix(), &jobs);
+			scene.buildInstances(pool, list, &jobs);
+			buildMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+			mismatches += drawListFingerprint(list) != reference[frame];
+		}
+		buildMs /= frames;
+		if (threads == 1)
+		{
+			singleThreadMs = buildMs;
+		}
+
+		// Whole frames, with copying the list's matrices standing in for the GL upload, unpipelined then pipelined
+		double frameMs[2];
+		for (int pipelined = 0; pipelined < 2; pipelined++)
+		{
+			FramePipeline pipeline(jobs, pipelined != 0);
+			resetScalingCamera(fieldSize);
+			auto start = chrono::high_resolution_clock::now();
+			for (int frame = 0; frame < frames; frame++)
+			{
+				flyScalingCamera(frame);
+				animateDemoScene(scene, frame / 60.0f);
+				scene.setLodView(cameraPosition, fov);
+				pipeline.startBuild(scene, pool, computeViewMatrix(), computeProjectionMatrix(1280, 720));
+				const DrawList* ready = pipeline.listToSubmit();
+				if (ready)
+				{
+					submitted.assign(ready->transforms.begin(), ready->transforms.end());
+				}
+				pipeline.endFrame();
+			}
+			frameMs[pipelined] = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count() / frames;
+		}
+
+		cout << threads << " threads: build " << buildMs << " ms per frame (" << singleThreadMs / buildMs << "x), " << jobs.steals()
+			<< " steals; frame " << frameMs[0] << " ms, pipelined " << frameMs[1] << " ms";
+		if (mismatches)
+		{
+			cout << ", " << mismatches << " frames DIFFER from the single-threaded lists";
+			failures++;
+		}
+		cout << endl;
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+int runDrawSortBenchmark(int objects, int frames)
+{
+	int failures = 0;
+
+	// Radix sort against a stable comparison sort on random keys
+	{
+		mt19937_64 random(42);
+		vector<DrawKey> keys(objects), radixKeys, keyScratch(objects);
+		vector<unsigned int> radixValues(objects), valueScratch(objects);
+		for (int i = 0; i < objects; i++)
+		{
+			// Realistic keys: only a few programs and materials, so most bytes are shared
+			keys[i] = makeDrawKey((RenderPass)(random() % 2), (GLuint)(random() % 4), 1, (GLuint)(random() % 32), (unsigned int)(random() % depthBucketCount), (int)(random() % 64));
+			radixValues[i] = i;
+		}
+		radixKeys = keys;
+		vector<pair<DrawKey, unsigned int>> reference(objects);
+		for (int i = 0; i < objects; i++)
+		{
+			reference[i] = make_pair(keys[i], (unsigned int)i);
+		}
+
+		auto start = chrono::high_resolution_clock::now();
+		radixSortKeys(radixKeys.data(), radixValues.data(), objects, keyScratch.data(), valueScratch.data());
+		auto radixEnd = chrono::high_resolution_clock::now();
+		stable_sort(reference.begin(), reference.end(), [](const pair<DrawKey, unsigned int>& a, const pair<DrawKey, unsigned int>& b) { return a.first < b.first; });
+		auto referenceEnd = chrono::high_resolution_clock::now();
+
+		size_t mismatches = 0;
+		for (int i = 0; i < objects; i++)
+		{
+			mismatches += radixKeys[i] != reference[i].first || radixValues[i] != reference[i].second;
+		}
+		cout << "Sorting " << objects << " keys: radix " << chrono::duration<double, milli>(radixEnd - start).count() << " ms, std::stable_sort "
+			<< chrono::duration<double, milli>(referenceEnd - radixEnd).count() << " ms" << endl;
+		if (mismatches)
+		{
+			cout << "FAIL radix sort differs from std::stable_sort at " << mismatches << " positions" << endl;
+			failures++;
+		}
+	}
+
+	// Synthetic scene with the LOD donuts made transparent, flown through like the other benchmarks
+	ScenePool pool;
+	Scene scene;
+	LodChain donutChain;
+	float fieldSize = buildSyntheticScene(pool, scene, objects, donutChain);
+	for (int mesh : donutChain.meshes)
+	{
+		pool.setMeshState(mesh, 1, true);
+	}
+	resetScalingCamera(fieldSize);
+
+	double unsortedChanges = 0.0, sortedChanges = 0.0, batches = 0.0, sortMs = 0.0;
+	size_t orderErrors = 0, blendErrors = 0, transparentDraws = 0;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		flyScalingCamera(frame);
+		animateDemoScene(scene, frame / 60.0f);
+		scene.setLodView(cameraPosition, fov);
+		scene.cull(pool, computeProjectionMatrix(1280, 720) * computeViewMatrix());
+		scene.buildInstances(pool);
+		const DrawSortStats& stats = scene.sortStats();
+		unsortedChanges += stats.unsortedChanges;
+		sortedChanges += stats.sortedChanges;
+		batches += scene.drawBatches().size();
+		sortMs += stats.sortMs;
+
+		// Opaque batches first; within one state, opaque buckets grow with distance
+		const ArenaArray<DrawBatch>& list = scene.drawBatches();
+		for (size_t i = 1; i < list.size(); i++)
+		{
+			DrawKey previous = list[i - 1].key, key = list[i].key;
+			if (keyPass(key) < keyPass(previous))
+			{
+				orderErrors++;
+			}
+			if (keyPass(key) == OpaquePass && keyPass(previous) == OpaquePass && keyProgram(key) == keyProgram(previous) && keyMaterial(key) == keyMaterial(previous))
+			{
+				const glm::mat4& a = scene.instanceTransforms()[list[i - 1].firstInstance];
+				const glm::mat4& b = scene.instanceTransforms()[list[i].firstInstance];
+				float nearer = glm::length(glm::vec3(a[3]) - cameraPosition), farther = glm::length(glm::vec3(b[3]) - cameraPosition);
+				if (keyDepthBucket(key) < keyDepthBucket(previous) || nearer > farther * 2.0f + 1.0f)
+				{
+					orderErrors++;
+				}
+			}
+		}
+
+		// Every transparent draw, across materials and batches, at most one bucket's width (well under 2%) nearer than
+		// the one after it
+		float lastDistance = 0.0f;
+		bool firstTransparent = true;
+		for (const DrawBatch& batch : list)
+		{
+			if (keyPass(batch.key) != TransparentPass)
+			{
+				continue;
+			}
+			AABB bounds = pool.storedBounds(batch.mesh);
+			glm::vec4 center((bounds.min + bounds.max) * 0.5f, 1.0f);
+			for (GLuint i = 0; i < batch.instanceCount; i++)
+			{
+				float distance = glm::length(glm::vec3(scene.instanceTransforms()[batch.firstInstance + i] * center) - cameraPosition);
+				if (!firstTransparent && distance > lastDistance * 1.02f)
+				{
+					blendErrors++;
+				}
+				lastDistance = distance;
+				firstTransparent = false;
+				transparentDraws++;
+			}
+		}
+	}
+
+	cout << "Visible objects sorted into " << batches / frames << " batches per frame, " << sortMs / frames << " ms per frame" << endl;
+	cout << "State changes per frame: " << unsortedChanges / frames << " in scene order, " << sortedChanges / frames << " sorted" << endl;
+	if (orderErrors)
+	{
+		cout << "FAIL " << orderErrors << " batches out of pass or depth order" << endl;
+		failures++;
+	}
+	if (blendErrors)
+	{
+		cout << "FAIL " << blendErrors << " of " << transparentDraws << " transparent draws farther than the one before them" << endl;
+		failures++;
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+int runAllocationTest(int objects, int frames)
+{
+	ScenePool pool;
+	Scene scene;
+	LodChain donutChain;
+	float fieldSize = buildSyntheticScene(pool, scene, objects, donutChain);
+	cout << "Objects: " << objects << ", frames: " << frames << endl;
+
+	// One thread runs everything on the caller; four make workers steal even on a single core
+	int failures = 0;
+	const unsigned int threadCounts[] = { 1, 4 };
+	for (unsigned int threads : threadCounts)
+	{
+		JobSystem jobs(threads);
+		for (int pipelined = 0; pipelined < 2; pipelined++)
+		{
+			FramePipeline pipeline(jobs, pipelined != 0);
+
+			// The first flight grows the arena, job queues and culling vectors to their high-water marks; the
+			// second flies the same path and must not allocate at all
+			unsigned long long allocations = 0, bytes = 0;
+			size_t checksum = 0;
+			for (int pass = 0; pass < 2; pass++)
+			{
+				resetScalingCamera(fieldSize);
+				unsigned long long startCount = heapAllocationCount(), startBytes = heapAllocatedBytes();
+				for (int frame = 0; frame < frames; frame++)
+				{
+					flyScalingCamera(frame);
+					animateDemoScene(scene, frame / 60.0f);
+					scene.setLodView(cameraPosition, fov);
+					pipeline.startBuild(scene, pool, computeViewMatrix(), computeProjectionMatrix(1280, 720));
+					const DrawList* ready = pipeline.listToSubmit();
+					if (ready)
+					{
+						// Reading the list stands in for the GL upload
+						checksum += ready->transforms.size() + ready->batches.size();
+					}
+					pipeline.endFrame();
+				}
+				allocations = heapAllocationCount() - startCount;
+				bytes = heapAllocatedBytes() - startBytes;
+			}
+
+			const ArenaStats& arena = scene.arenaStats();
+			cout << threads << (threads == 1 ? " thread" : " threads") << (pipelined ? ", pipelined: " : ": ") << allocations << " heap allocations ("
+				<< bytes << " bytes) in " << frames << " steady frames; arena " << arena.bytesUsed / 1024 << " KB of " << arena.capacity / 1024
+				<< " KB per frame, " << arena.overflows << " overflows during warm-up" << endl;
+			if (allocations != 0)
+			{
+				cout << "FAIL the render loop allocated after warming up" << endl;
+				failures++;
+			}
+			if (checksum == 0)
+			{
+				cout << "FAIL no draw lists reached submission" << endl;
+				failures++;
+			}
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+// Largest difference between two matrices' elements
+static float matrixDifference(const glm::mat4& a, const glm::mat4& b)
+{
+	float difference = 0.0f;
+	for (int column = 0; column < 4; column++)
+	{
+		for (int row = 0; row < 4; row++)
+		{
+			difference = max(difference, fabs(a[column][row] - b[column][row]));
+		}
+	}
+	return difference;
+}
+
+// Scripted idle session at 60 frames per second: the camera flies forward for two seconds, rests, turns for half
+// a second, and the window is damaged once. Returns frames whose screen showed an older camera than the current
+// one while redraws were skipped, and counts drawn and skipped frames.
+static int runRedrawSession(bool pipelined, int settleFrames, int& drawn, int& skipped)
+{
+	resetCameraForReplay();
+	FixedTimestep simulation(simulationStep);
+	CameraState previous = captureCameraState(), current = previous;
+	RenderCamera camera;
+	camera.setViewport(1280, 720);
+	RedrawTracker redraw(settleFrames);
+
+	unsigned int builtVersion = 0, shownVersion = 0;		// Camera of the list in flight and of the presented frame
+	bool built = false;
+	int stale = 0;
+	drawn = skipped = 0;
+	for (int frame = 0; frame < 600; frame++)
+	{
+		int ticks = simulation.advance(1.0 / 60.0);
+		for (int tick = 0; tick < ticks; tick++)
+		{
+			long long t = simulation.ticks() - ticks + tick;
+			CameraInput input;
+			input.keys = t < 240 ? MoveForward : 0;
+			input.xTurn = t >= 600 && t < 660 ? 2.0f : 0.0f;
+			previous = current;
+			stepCamera(input);
+			current = captureCameraState();
+		}
+		CameraState state = interpolateCameraState(previous, current, simulation.alpha());
+		camera.setPose(state.position, state.front, cameraUp);
+		camera.setLens(fov, perspective);
+		if (frame == 450)
+		{
+			redraw.requestRedraw();
+		}
+
+		if (!redraw.needsRedraw(camera.version(), false))
+		{
+			skipped++;
+			stale += shownVersion != camera.version();
+			continue;
+		}
+		drawn++;
+
+		// Pipelined frames present the list built during the previous frame
+		if (pipelined)
+		{
+			if (built)
+			{
+				shownVersion = builtVersion;
+			}
+			builtVersion = camera.version();
+			built = true;
+		}
+		else
+		{
+			shownVersion = camera.version();
+		}
+	}
+	return stale;
+}
+
+int runCameraTest()
+{
+	int failures = 0;
+
+	// Lazy matrices match the ones computed from scratch
+	mt19937 random(7);
+	uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	RenderCamera camera;
+	float maxError = 0.0f;
+	for (int i = 0; i < 100; i++)
+	{
+		glm::vec3 position(unit(random) * 20.0f, unit(random) * 20.0f, unit(random) * 20.0f);
+		glm::vec3 front = glm::normalize(glm::vec3(unit(random), unit(random) * 0.5f, unit(random)) + glm::vec3(0.0f, 0.0f, 0.01f));
+		float lensFov = 30.0f + (unit(random) + 1.0f) * 30.0f;
+		bool lensPerspective = i % 3 != 0;
+		int viewportWidth = 320 + (i * 37) % 1600, viewportHeight = 240 + (i * 53) % 900;
+		camera.setPose(position, front, cameraUp);
+		camera.setLens(lensFov, lensPerspective);
+		camera.setViewport(viewportWidth, viewportHeight);
+		glm::mat4 view = glm::lookAt(position, position + front, cameraUp);
+		glm::mat4 projection = computeProjectionMatrix(viewportWidth, viewportHeight, lensFov, lensPerspective);
+		maxError = max(maxError, matrixDifference(camera.view(), view));
+		maxError = max(maxError, matrixDifference(camera.projection(), projection));
+		maxError = max(maxError, matrixDifference(camera.viewProjection(), projection * view));
+	}
+	cout << "Lazy matrices: max difference from recomputed " << maxError << endl;
+	if (maxError > 1e-6f)
+	{
+		cout << "FAIL lazy camera matrices differ" << endl;
+		failures++;
+	}
+
+	// Setting the same state again changes nothing and rebuilds nothing
+	const glm::vec3 restPosition(1.0f, 2.0f, 3.0f), restFront(0.0f, 0.0f, -1.0f);
+	camera.setPose(restPosition, restFront, cameraUp);
+	camera.viewProjection();
+	unsigned int version = camera.version(), recomputes = camera.recomputes();
+	for (int i = 0; i < 1000; i++)
+	{
+		camera.setPose(restPosition, restFront, cameraUp);
+		camera.setLens(camera.fov(), camera.perspective());
+		camera.viewProjection();
+	}
+	if (camera.version() != version || camera.recomputes() != recomputes)
+	{
+		cout << "FAIL unchanged camera was rebuilt" << endl;
+		failures++;
+	}
+
+	// A resize rebuilds the projection but not the view
+	camera.setViewport(1000, 1000);
+	camera.viewProjection();
+	if (camera.version() != version + 1 || camera.recomputes() != recomputes + 1)
+	{
+		cout << "FAIL resizing rebuilt " << camera.recomputes() - recomputes << " matrices instead of 1" << endl;
+		failures++;
+	}
+
+	// Idle frames are skipped, and whatever stays on screen shows the current camera
+	for (int pipelined = 0; pipelined < 2; pipelined++)
+	{
+		int drawn = 0, skipped = 0;
+		int stale = runRedrawSession(pipelined != 0, pipelined ? 2 : 1, drawn, skipped);
+		cout << (pipelined ? "Pipelined" : "Unpipelined") << ": " << drawn << " frames drawn, " << skipped << " skipped, " << stale << " stale" << endl;
+		if (stale != 0 || skipped < 400)
+		{
+			cout << "FAIL idle frames were " << (stale != 0 ? "left showing an old camera" : "not skipped") << endl;
+			failures++;
+		}
+	}
+
+	// Settling for one frame only while pipelined would leave the second-to-last camera on screen
+	int drawn = 0, skipped = 0;
+	if (runRedrawSession(true, 1, drawn, skipped) == 0)
+	{
+		cout << "FAIL the session does not detect a stale screen" << endl;
+		failures++;
+	}
+
+	cout << (failures == 0 ? "Camera checks passed" : "Camera checks FAILED") << endl;
+	return failures == 0 ? 0 : 1;
+}
+
+int runDepthPrecisionTest()
+{
+	const int targetWidth = 640, targetHeight = 360;
+	GLFWwindow* window = createOffscreenContext(64, 64);
+	if (!window)
+	{
+		return -1;
+	}
+	if (!reverseDepthSupported())
+	{
+		cout << "Reverse-Z needs OpenGL 4.5 or ARB_clip_control" << endl;
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return -1;
+	}
+
+	// Standard 24-bit depth as drawn today, and reverse-Z on float depth
+	Framebuffer standardTarget, reverseTarget;
+	if (!standardTarget.create(targetWidth, targetHeight) || !reverseTarget.create(targetWidth, targetHeight, true))
+	{
+		standardTarget.destroy();
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return -1;
+	}
+
+	// A red quad with a green quad just in front of it, both facing the camera
+	ScenePool pool;
+	int backMesh = pool.addMesh(generateShape(planeShape(2.0f, 2.0f, 1, glm::vec3(1.0f, 0.0f, 0.0f)), 0));
+	int frontMesh = pool.addMesh(generateShape(planeShape(2.0f, 2.0f, 1, glm::vec3(0.0f, 1.0f, 0.0f)), 0));
+	pool.upload();
+	GLuint shaderProgram = CreateShaderProgram(vertexShaderSource, fragmentShaderSource);
+	BindCameraBlock(shaderProgram);
+	CameraUniformBuffer cameraBuffer;
+	cameraBuffer.create();
+	RenderState renderState;
+	glEnable(GL_DEPTH_TEST);
+
+	// Today's projection needs its far plane pushed out to see the farthest pair at all; reverse-Z has none
+	const float fovDegrees = 45.0f, aspect = (float)targetWidth / targetHeight;
+	const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::mat4 standardProjection = glm::perspective(glm::radians(fovDegrees), aspect, 0.1f, 100000.0f);
+	const glm::mat4 reverseProjection = reverseInfinitePerspective(glm::radians(fovDegrees), aspect, 0.1f);
+
+	// The gap between the quads is 0.01% of their distance
+	const float distances[] = { 10.0f, 100.0f, 1000.0f, 10000.0f, 50000.0f };
+	const float separation = 1e-4f;
+	vector<unsigned char> pixels(targetWidth * targetHeight * 4);
+	int failures = 0;
+	cout << "Pixels where the far quad shows through the near one (depth fighting), gap " << separation * 100.0f << "% of distance:" << endl;
+	for (float distance : distances)
+	{
+		// Quads scaled past the edges of the view
+		float halfSize = distance * tan(glm::radians(fovDegrees) * 0.5f) * aspect * 1.2f;
+		glm::mat4 facing = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)) * glm::scale(glm::mat4(1.0f), glm::vec3(halfSize, 1.0f, halfSize));
+		Scene scene;
+		scene.addObject(backMesh, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -distance)) * facing);
+		scene.addObject(frontMesh, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -distance * (1.0f - separation))) * facing);
+		scene.selectAll();
+		scene.setLodView(glm::vec3(0.0f), fovDegrees);
+		scene.buildInstances(pool);
+
+		double fighting[2];
+		for (int reverse = 0; reverse < 2; reverse++)
+		{
+			(reverse ? reverseTarget : standardTarget).bind();
+			applyDepthConvention(reverse != 0);
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			cameraBuffer.update(view, reverse ? reverseProjection : standardProjection);
+			renderState.useProgram(shaderProgram);
+			pool.uploadInstances(scene.instanceTransforms().data(), scene.instanceTransforms().size());
+			pool.draw(renderState, scene.drawBatches().data(), scene.drawBatches().size());
+			glReadPixels(0, 0, targetWidth, targetHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+			size_t red = 0, green = 0;
+			for (size_t i = 0; i < pixels.size(); i += 4)
+			{
+				red += pixels[i] > 127 && pixels[i + 1] <= 127;
+				green += pixels[i + 1] > 127;
+			}
+			fighting[reverse] = 100.0 * red / (targetWidth * targetHeight);
+			if (red + green < (size_t)targetWidth * targetHeight * 9 / 10)
+			{
+				cout << "FAIL the quads at " << distance << " do not cover the view" << endl;
+				failures++;
+			}
+		}
+		cout << "  distance " << distance << ": standard 24-bit " << fighting[0] << "%, reverse-Z float " << fighting[1] << "%" << endl;
+		if (fighting[1] > 0.5)
+		{
+			cout << "FAIL reverse-Z depth fights on more than 0.5% of the view at " << distance << endl;
+			failures++;
+		}
+	}
+	cout << (failures == 0 ? "Depth precision checks passed" : "Depth precision checks FAILED") << endl;
+
+	// Release GPU resources
+	applyDepthConvention(false);
+	renderState.invalidate();
+	pool.destroy();
+	cameraBuffer.destroy();
+	glDeleteProgram(shaderProgram);
+	standardTarget.destroy();
+	reverseTarget.destroy();
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return failures == 0 ? 0 : 1;
+}
+
+int runOcclusionTest(int objects, int frames)
+{
+	const int targetWidth = 640, targetHeight = 360;
+	GLFWwindow* window = createOffscreenContext(64, 64);
+	if (!window)
+	{
+		return -1;
+	}
+	if (!OcclusionCuller::supported())
+	{
+		cout << "Occlusion culling needs OpenGL 4.3 (ALMOND_OSMESA=1 selects llvmpipe)" << endl;
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return -1;
+	}
+	cout << "Renderer: " << (const char*)glGetString(GL_RENDERER) << ", " << (const char*)glGetString(GL_VERSION) << endl;
+
+	// A wall 15 units down the view, the only occluder
+	ScenePool pool;
+	int wall = pool.addMesh(generateShape(boxShape(glm::vec3(16.0f, 10.0f, 1.0f), glm::vec3(0.5f)), 0));
+	int donut = pool.addMesh(generateShape(torusShape(0.6f, 0.25f, 32, glm::vec3(0.85f, 0.55f, 0.3f)), 0));
+	pool.setMeshOccluder(wall, true);
+	pool.upload();
+	Scene scene;
+	scene.addObject(wall, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -15.0f)));
+
+	// Layers of 10x10 donuts well inside the wall's shadow (0.53 by 0.33 of the distance), with margin for the
+	// coarse Hi-Z level the outer ones are tested against, so every one of them must be culled
+	for (int i = 0; i < objects; i++)
+	{
+		float z = -20.0f - (i / 100) * 2.0f;
+		float x = ((i % 10) - 4.5f) / 4.5f * 0.3f * -z;
+		float y = ((i / 10 % 10) - 4.5f) / 4.5f * 0.17f * -z;
+		scene.addObject(donut, glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z)));
+	}
+
+	// Donuts beside the wall, across its edges and in front of it, all at least partly visible
+	const float wallEdge = 8.0f / 14.5f;
+	for (int i = 0; i < 20; i++)
+	{
+		float z = -20.0f - i * 2.0f;
+		float side = i % 2 ? 1.0f : -1.0f;
+		float y = ((i % 5) - 2) * 0.1f * -z;
+		scene.addObject(donut, glm::translate(glm::mat4(1.0f), glm::vec3(side * 0.65f * -z, y, z)));
+		scene.addObject(donut, glm::translate(glm::mat4(1.0f), glm::vec3(side * wallEdge * -z, y, z)));
+	}
+	for (int i = 0; i < 5; i++)
+	{
+		scene.addObject(donut, glm::translate(glm::mat4(1.0f), glm::vec3((i - 2) * 2.0f, 0.0f, -8.0f)));
+	}
+
+	GLuint shaderProgram = CreateShaderProgram(vertexShaderSource, fragmentShaderSource);
+	BindCameraBlock(shaderProgram);
+	CameraUniformBuffer cameraBuffer;
+	cameraBuffer.create();
+	OcclusionCuller occlusion;
+	if (!shaderProgram || !occlusion.create())
+	{
+		pool.destroy();
+		cameraBuffer.destroy();
+		glDeleteProgram(shaderProgram);
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return -1;
+	}
+	RenderState renderState;
+	glEnable(GL_DEPTH_TEST);
+
+	const float fovDegrees = 45.0f, aspect = (float)targetWidth / targetHeight;
+	const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	vector<unsigned char> images[2];
+	int failures = 0;
+	for (int reverse = 0; reverse < (reverseDepthSupported() ? 2 : 1); reverse++)
+	{
+		Framebuffer target;
+		if (!target.create(targetWidth, targetHeight, reverse != 0))
+		{
+			failures++;
+			continue;
+		}
+		target.bind();
+		applyDepthConvention(reverse != 0);
+		glm::mat4 projection = reverse ? reverseInfinitePerspective(glm::radians(fovDegrees), aspect, 0.1f)
+			: glm::perspective(glm::radians(fovDegrees), aspect, 0.1f, 100.0f);
+		cameraBuffer.update(view, projection);
+		scene.cull(pool, projection * view);
+		scene.setLodView(glm::vec3(0.0f), fovDegrees);
+		scene.buildInstances(pool);
+		const ArenaArray<glm::mat4>& transforms = scene.instanceTransforms();
+		const ArenaArray<DrawBatch>& batches = scene.drawBatches();
+
+		// Draw every frustum-visible instance, then only the ones that pass the Hi-Z test
+		double frameMs[2];
+		for (int culled = 0; culled < 2; culled++)
+		{
+			auto start = chrono::high_resolution_clock::now();
+			for (int frame = 0; frame < frames; frame++)
+			{
+				glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				renderState.useProgram(shaderProgram);
+				pool.uploadInstances(transforms.data(), transforms.size());
+				if (culled)
+				{
+					occlusion.cull(pool, renderState, batches.data(), batches.size(), reverse != 0);
+					occlusion.draw(pool, renderState, batches.data(), batches.size());
+				}
+				else
+				{
+					pool.draw(renderState, batches.data(), batches.size());
+				}
+				glFinish();
+			}
+			frameMs[culled] = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count() / max(frames, 1);
+			images[culled].resize(targetWidth * targetHeight * 4);
+			glReadPixels(0, 0, targetWidth, targetHeight, GL_RGBA, GL_UNSIGNED_BYTE, images[culled].data());
+		}
+
+		// Culling may only drop what the wall hides: the image must not change
+		OcclusionStats stats = occlusion.readStats();
+		size_t differing = 0;
+		for (size_t i = 0; i < images[0].size(); i += 4)
+		{
+			differing += memcmp(&images[0][i], &images[1][i], 4) != 0;
+		}
+		cout << (reverse ? "Reverse-Z" : "Standard depth") << ": " << stats.occluded << " of " << stats.tested << " instances hidden ("
+			<< objects << " behind the wall), " << differing << " pixels differ; " << frameMs[0] << " ms per frame drawing everything, "
+			<< frameMs[1] << " ms with occlusion culling (Hi-Z " << occlusion.pyramidWidth() << "x" << occlusion.pyramidHeight() << ")" << endl;
+		if (differing > 0)
+		{
+			cout << "FAIL occlusion culling changed the image" << endl;
+			failures++;
+		}
+		if (stats.occluded > (unsigned int)objects)
+		{
+			cout << "FAIL visible objects were culled" << endl;
+			failures++;
+		}
+		if (stats.occluded < (unsigned int)objects)
+		{
+			cout << "FAIL " << objects - stats.occluded << " objects behind the wall were drawn" << endl;
+			failures++;
+		}
+		target.destroy();
+	}
+	cout << (failures == 0 ? "Occlusion culling checks passed" : "Occlusion culling checks FAILED") << endl;
+
+	// Release GPU resources
+	applyDepthConvention(false);
+	renderState.invalidate();
+	occlusion.destroy();
+	pool.destroy();
+	cameraBuffer.destroy();
+	glDeleteProgram(shaderProgram);
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return failures == 0 ? 0 : 1;
+}
+
+// Spin for 'seconds' of simulated frame work
+static void spinFor(const FramePacer& pacer, double seconds)
+{
+	double end = pacer.now() + seconds;
+	while (pacer.now() < end)
+	{
+	}
+}
+
+int runFramePacingTest(int frames)
+{
+	int failures = 0;
+
+	// Percentiles come from bucket edges; the last bucket reports the slowest sample
+	LatencyHistogram histogram;
+	for (int i = 0; i < 90; i++)
+	{
+		histogram.add(5.0);
+	}
+	for (int i = 0; i < 9; i++)
+	{
+		histogram.add(15.0);
+	}
+	histogram.add(70.0);
+	cout << "Histogram of 90 x 5 ms, 9 x 15 ms, 1 x 70 ms: ";
+	histogram.print(cout);
+	cout << endl;
+	if (histogram.percentile(0.5) != 6.0 || histogram.percentile(0.95) != 16.0 || histogram.percentile(0.99) != 16.0 || histogram.percentile(1.0) != 70.0)
+	{
+		cout << "FAIL histogram percentiles" << endl;
+		failures++;
+	}
+
+	// Adaptive vsync at 60 Hz: late frames turn it off, a long enough run of fast frames turns it back on
+	AdaptiveVsync adaptive(1.0 / 60.0);
+	bool adaptiveOk = true;
+	for (int i = 0; i < 100; i++)
+	{
+		adaptiveOk = adaptiveOk && adaptive.update(1.0 / 60.0) == 1;
+	}
+	for (int i = 0; i < AdaptiveVsync::missesToDisable; i++)
+	{
+		adaptiveOk = adaptiveOk && adaptive.update(2.0 / 60.0) == (i + 1 < AdaptiveVsync::missesToDisable ? 1 : 0);
+	}
+	for (int i = 0; i < AdaptiveVsync::fitsToEnable; i++)
+	{
+		adaptiveOk = adaptiveOk && adaptive.update(0.010) == (i + 1 < AdaptiveVsync::fitsToEnable ? 0 : 1);
+	}
+	cout << "Adaptive vsync: " << (adaptiveOk ? "off after " : "FAIL not off after ") << AdaptiveVsync::missesToDisable << " late frames, on again after "
+		<< AdaptiveVsync::fitsToEnable << " fast ones" << endl;
+	failures += adaptiveOk ? 0 : 1;
+
+	// Frame limiter: random work up to 60% of the period must still give evenly spaced frames at the target rate
+	mt19937 random(7);
+	const double rates[] = { 60.0, 120.0, 240.0 };
+	for (double rate : rates)
+	{
+		FramePacer pacer(rate, VsyncOff);
+		uniform_real_distribution<double> work(0.0, 0.6 / rate);
+		vector<double> intervals;
+		pacer.waitForFrame();
+		double last = pacer.now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			spinFor(pacer, work(random));
+			pacer.waitForFrame();
+			double now = pacer.now();
+			intervals.push_back((now - last) * 1000.0);
+			last = now;
+		}
+		double mean = 0.0;
+		for (double interval : intervals)
+		{
+			mean += interval;
+		}
+		mean /= intervals.size();
+		sort(intervals.begin(), intervals.end());
+		double period = 1000.0 / rate;
+		cout << "Target " << rate << " Hz: mean interval " << mean << " ms (period " << period << " ms), p1 " << intervals[intervals.size() / 100]
+			<< " ms, p99 " << intervals[intervals.size() * 99 / 100] << " ms" << endl;
+		if (fabs(mean - period) > period * 0.03)
+		{
+			cout << "FAIL mean frame interval is off the target by more than 3%" << endl;
+			failures++;
+		}
+	}
+
+	// After a stall the limiter restarts its grid instead of rushing frames out to catch up
+	{
+		const double rate = 120.0;
+		FramePacer pacer(rate, VsyncOff);
+		pacer.waitForFrame();
+		spinFor(pacer, 0.1);
+		pacer.waitForFrame();
+		double last = pacer.now();
+		double shortest = 1.0e9;
+		for (int frame = 0; frame < 10; frame++)
+		{
+			pacer.waitForFrame();
+			double now = pacer.now();
+			shortest = min(shortest, (now - last) * 1000.0);
+			last = now;
+		}
+		cout << "Shortest interval after a 100 ms stall at " << rate << " Hz: " << shortest << " ms" << endl;
+		if (shortest < 500.0 / rate)
+		{
+			cout << "FAIL frames burst after a stall" << endl;
+			failures++;
+		}
+	}
+
+	cout << (failures == 0 ? "Frame pacing checks passed" : "Frame pacing checks FAILED") << endl;
+	return failures == 0 ? 0 : 1;
+}
+
+// Simulated scene: GPU time is a fixed part plus a part that follows the pixel count, with +-5% noise, and each
+// measurement reaches the controller two frames after the frame it timed, as with the query ring
+struct SyntheticLoad
+{
+	double fixedMs;
+	double fullResolutionMs;	// Pixel-bound part at scale 1
+};
+
+static float runSyntheticFrames(ResolutionController& controller, const SyntheticLoad& load, int frames, mt19937& random,
+	vector<float>& scales, vector<double>& times)
+{
+	uniform_real_distribution<double> noise(0.95, 1.05);
+	deque<double> inFlight;
+	float scale = controller.scale();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		double ms = (load.fixedMs + load.fullResolutionMs * scale * scale) * noise(random);
+		scales.push_back(scale);
+		times.push_back(ms);
+		inFlight.push_back(ms);
+		if (inFlight.size() > 2)
+		{
+			scale = controller.update(inFlight.front());
+			inFlight.pop_front();
+		}
+	}
+	return scale;
+}
+
+int runDynamicResolutionTest(int frames)
+{
+	int failures = 0;
+	const double budget = 1000.0 / 60.0;
+	mt19937 random(11);
+	ResolutionController controller(budget);
+
+	// Twice the budget at full resolution: settle on one scale within budget and stay there
+	vector<float> scales;
+	vector<double> times;
+	runSyntheticFrames(controller, { 2.0, budget * 2.0 - 2.0 }, frames, random, scales, times);
+	int half = frames / 2;
+	int settledChanges = 0;
+	int settledHits = 0;
+	for (int i = half; i < frames; i++)
+	{
+		settledChanges += scales[i] != scales[i - 1];
+		settledHits += times[i] <= budget;
+	}
+	int converged = frames - 1;
+	while (converged > 0 && scales[converged - 1] == scales[frames - 1])
+	{
+		converged--;
+	}
+	cout << "Heavy load (" << budget * 2.0 << " ms at full resolution, " << budget << " ms budget): scale " << scales[frames - 1] << " from frame "
+		<< converged << ", " << settledChanges << " changes and " << settledHits << " / " << frames - half << " frames within budget in the second half" << endl;
+	if (settledChanges > 1 || settledHits < (frames - half) * 0.9 || scales[frames - 1] >= 1.0f)
+	{
+		cout << "FAIL heavy load did not settle within budget" << endl;
+		failures++;
+	}
+
+	// Load drops to 30% of the budget: back to full resolution
+	scales.clear();
+	times.clear();
+	float light = runSyntheticFrames(controller, { 1.0, budget * 0.3 - 1.0 }, frames, random, scales, times);
+	converged = frames - 1;
+	while (converged > 0 && scales[converged - 1] == scales[frames - 1])
+	{
+		converged--;
+	}
+	cout << "Light load (" << budget * 0.3 << " ms at full resolution): scale " << light << " from frame " << converged << endl;
+	if (light != 1.0f)
+	{
+		cout << "FAIL light load did not return to full resolution" << endl;
+		failures++;
+	}
+
+	// Far over budget even at the smallest scale: clamp there without oscillating
+	scales.clear();
+	times.clear();
+	controller.clearStats();
+	float clamped = runSyntheticFrames(controller, { 2.0, budget * 10.0 }, frames, random, scales, times);
+	float smallest = *min_element(scales.begin(), scales.end());
+	int lateChanges = 0;
+	for (int i = half; i < frames; i++)
+	{
+		lateChanges += scales[i] != scales[i - 1];
+	}
+	cout << "Extreme load (" << budget * 10.0 + 2.0 << " ms at full resolution): scale " << clamped << ", smallest " << smallest << ", "
+		<< controller.stats().scaleChanges << " changes" << endl;
+	if (clamped != 0.5f || smallest < 0.5f || lateChanges > 0)
+	{
+		cout << "FAIL extreme load did not hold the minimum scale" << endl;
+		failures++;
+	}
+
+	cout << (failures == 0 ? "Dynamic resolution checks passed" : "Dynamic resolution checks FAILED") << endl;
+	return failures == 0 ? 0 : 1;
+}
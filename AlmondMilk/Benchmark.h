@@ -0,0 +1,93 @@
+#pragma once
+
+// Headless benchmark comparing per-VAO draws with the scene geometry pool.
+// Renders 'copies' copies of every primitive for 'frames' frames and prints draw calls and CPU submit time.
+int runPoolBenchmark(int copies, int frames);
+
+// Headless CPU check of the 12-byte vertex layout. Quantizes the demo primitives and every generated shape at each
+// demo level of detail, and fails unless positions decode within the bounding box extent / 65535 per axis, colors
+// within 1/255, and the vertex data is exactly half the size of the float layout.
+int runCompactVertexTest();
+
+// Headless CPU benchmark of BVH frustum culling. Flies the WASD/mouse camera through a synthetic
+// scene of 'objects' donut boxes for 'frames' frames and prints cull time and visible counts.
+// With a recording from --record, the camera follows the recorded input instead, one tick per frame.
+int runCullBenchmark(int objects, int frames, const char* recording = nullptr);
+
+// Headless CPU benchmark of the SIMD transform and cull kernel. Runs 'iterations' passes over 'objects'
+// spinning donut boxes on every path this CPU supports, prints objects per ms and checks each path
+// against glm matrices and the scalar frustum test.
+int runTransformBenchmark(int objects, int iterations);
+
+// Headless check of the fixed-timestep camera. Plays a 'seconds' long session of key, cursor and scroll events
+// under several render frame rates (steady, jittered and stalling), gathering them per frame like the render loop.
+// Every run must apply all cursor and scroll input exactly once and move the held distance within one frame, and
+// the interpolated render pose must never step back or run ahead of the latest tick.
+int runTimestepReplayTest(double seconds);
+
+// Headless replay of an input recording. Steps the camera through every recorded tick twice and
+// prints the final camera and a hash of the trajectory; the two passes must match bit for bit.
+int runInputReplay(const char* path);
+
+// Headless frame benchmark. Renders the interactive scene plus 'donutBoxes' spinning copies into a 1280x720
+// framebuffer on an offscreen context for 'frames' frames of a scripted camera path, and writes CPU frame time
+// percentiles, draw calls and triangles per second as JSON to 'jsonPath' (stdout when NULL).
+int runFrameBenchmark(int frames, int donutBoxes, const char* jsonPath);
+
+// Headless shader startup benchmark. Compiles 'programs' variants of the scene program from source one
+// at a time (cold), all at once (parallel compile when supported), then loads them from the binary
+// cache (warm), and prints milliseconds per program for each path.
+int runShaderBenchmark(int programs);
+
+// Headless scene loading benchmark. Loads 'objPath' (a generated grid of about one million triangles when NULL)
+// by parsing the OBJ text and by mapping the converted scene file, uploads both to an offscreen context,
+// and prints the load time of each path averaged over 'iterations' runs.
+int runSceneLoadBenchmark(const char* objPath, int iterations);
+
+// Headless checks of the procedural mesh generator: vertex and triangle counts of every shape, watertightness
+// and orientation at every level of detail, LOD switch distances, and a batch of 'shapes' generated on one
+// thread and on every core, which must give identical meshes.
+int runMeshGeneratorTest(int shapes);
+
+// Headless CPU benchmark of multithreaded draw list building. Culls and groups a synthetic scene of 'objects'
+// donut boxes, LOD donuts and spinning donut boxes for 'frames' frames on 1, 2, 4, ... threads up to one per
+// core, checks every list against one built on a single thread, and times whole frames with and without
+// building the next frame's list while the current one is submitted.
+int runThreadScalingBenchmark(int objects, int frames);
+
+// Headless CPU benchmark of draw sorting. Radix sorts 'objects' random DrawKeys and checks the result against
+// std::stable_sort, then flies through the synthetic scene with its donuts transparent for 'frames' frames and
+// reports batches and GL state changes per frame in scene order and sorted, checking pass and depth order.
+int runDrawSortBenchmark(int objects, int frames);
+
+// Headless check that the CPU side of the render loop stops allocating. Flies through the synthetic scene of
+// 'objects' objects for 'frames' frames to warm up, then flies the same path again while counting operator new
+// on every thread, on 1 and 4 threads, with and without pipelining. Any allocation in the second flight fails.
+int runAllocationTest(int objects, int frames);
+
+// Headless checks of the lazy camera: its matrices match ones computed from scratch, setting unchanged state
+// rebuilds nothing, and in a scripted session with the camera at rest redraws are skipped while the screen
+// still shows the final camera, with and without pipelining.
+int runCameraTest();
+
+// Headless depth precision test. Renders pairs of camera-facing quads 0.01% of their distance apart at 10 to
+// 50000 units with today's projection (far plane pushed out to 100000, 24-bit depth) and with reverse-Z on a
+// float depth buffer, and prints the share of pixels where the far quad shows through. Reverse-Z must stay
+// under 0.5% at every distance.
+int runDepthPrecisionTest();
+
+// Headless check of GPU occlusion culling. Draws a wall with 'objects' donuts behind it and donuts beside it,
+// across its edges and in front of it, 'frames' times with every instance drawn and with Hi-Z occlusion culling,
+// in standard and (when supported) reverse-Z depth. The images must match pixel for pixel, no visible donut may
+// be culled and every hidden one must be. Prints frame times of both; needs OpenGL 4.3.
+int runOcclusionTest(int objects, int frames);
+
+// Headless CPU checks of frame pacing: latency histogram percentiles, adaptive vsync switching off after late
+// frames and back on after fast ones, the frame limiter holding 60, 120 and 240 Hz within 3% over 'frames' frames
+// of random work, and no burst of short frames after a stall.
+int runFramePacingTest(int frames);
+
+// Headless CPU checks of the dynamic resolution controller against a synthetic GPU load with two frames of
+// measurement delay: at twice the budget it must settle on one scale with at least 90% of the second half's frames
+// within budget, return to full resolution when the load drops, and hold the minimum scale under extreme load.
+int runDynamicResolutionTest(int frames);
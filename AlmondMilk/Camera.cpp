@@ -0,0 +1,205 @@
+#include "Camera.h"
+
+#include <cmath>
+
+// GLM Libraries
+#include <glm/gtc/matrix_transform.hpp> 
+
+// Define camera attributes
+glm::vec3 cameraPosition = glm::vec3(0.0f, 2.0f, 10.0f);
+glm::vec3 target = glm::vec3(0.0f, 5.0f, 0.0f);
+glm::vec3 cameraDirection = glm::normalize(cameraPosition - target);
+glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
+glm::vec3 cameraRight = glm::normalize(glm::cross(worldUp, cameraDirection));
+glm::vec3 cameraUp = glm::normalize(glm::cross(cameraDirection, cameraRight));
+glm::vec3 cameraFront = glm::normalize(glm::vec3(0.0f, 0.0f, -1.0f));
+
+// Pitch, yaw, 
+GLfloat yaw = -90.0f, pitch = 0.0f;
+GLfloat fov = 45.0f;		// Declare and nitialize field of view
+bool perspective = true;
+bool reverseDepth = false;
+// Variables for scroll and cursor
+GLfloat cameraMovement = 10.0f;
+GLfloat cameraSpeed = 2.5f;
+
+// Function with coordinates to reset camera to look at scene
+void initCamera()
+{
+	cameraPosition = glm::vec3(0.0f, 2.0f, 15.0f);
+	target = glm::vec3(0.0f, 5.0f, 0.0f);
+	cameraDirection = glm::normalize(cameraPosition - target);
+	worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
+	cameraRight = glm::normalize(glm::cross(worldUp, cameraDirection));
+	cameraUp = glm::normalize(glm::cross(cameraDirection, cameraRight));
+	cameraFront = glm::normalize(glm::vec3(0.0f, 0.0f, -1.0f));
+}
+
+// Move camera with the held movement keys
+void moveCamera(unsigned int keys, GLfloat deltaTime)
+{
+	cameraSpeed = cameraMovement * deltaTime;					// Calculate camera speed based on scroll
+
+	if (keys & MoveForward)			// Move camera forward (toward object)
+	{
+		cameraPosition += cameraSpeed * cameraFront;
+	}
+	if (keys & MoveBackward)		// Move camera backward (away from object)
+	{
+		cameraPosition -= cameraSpeed * cameraFront;
+	}
+	if (keys & MoveLeft)			// Move camera left
+	{
+		cameraPosition -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+	}
+	if (keys & MoveRight)			// Move camera right
+	{
+		cameraPosition += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+	}
+	if (keys & MoveDown)			// Move camera down
+	{
+		cameraPosition -= cameraSpeed * cameraUp;
+	}
+	if (keys & MoveUp)				// Move camera up
+	{
+		cameraPosition += cameraSpeed * cameraUp;
+	}
+}
+
+// Change the orientation of the camera from a cursor offset
+void turnCamera(GLfloat xOffset, GLfloat yOffset)
+{
+	// Lessen sensitivity of mouse movement
+	GLfloat sensitivity = 0.1f;
+	xOffset *= sensitivity;
+	yOffset *= sensitivity;
+
+	// Add ofset values to global yaw and pitch
+	yaw += xOffset;
+	pitch += yOffset;
+
+	// Prevent screen from flipping
+	if (pitch > 89.0f)
+	{
+		pitch = 89.0f;
+	}
+	if (pitch < -89.0f)
+	{
+		pitch = -89.0f;
+	}
+
+	// Calculate actual direction vector to contain rotations from mouse movement
+	glm::vec3 front;
+	front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+	front.y = sin(glm::radians(pitch));
+	front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+	cameraFront = glm::normalize(front);
+}
+
+// Control speed at which camera moves with scroll; Adjust the speed of the movement
+void changeCameraMovement(GLfloat yOffset)
+{
+	// Clamp cameraMovement
+	if (cameraMovement >= 1.0f && cameraMovement <= 55.0f)
+	{
+		cameraMovement -= yOffset;
+	}
+
+	// Default cameraMovement
+	if (cameraMovement < 1.0f)
+	{
+		cameraMovement = 1.0f;
+	}
+
+	if (cameraMovement > 55.0f)
+	{
+		cameraMovement = 55.0f;
+	}
+}
+
+// One fixed tick: apply the turn and scroll gathered since the last tick, then move for exactly simulationStep
+void stepCamera(const CameraInput& input)
+{
+	if (input.keys & ResetCamera)
+	{
+		initCamera();
+	}
+	if (input.xTurn != 0.0f || input.yTurn != 0.0f)
+	{
+		turnCamera(input.xTurn, input.yTurn);
+	}
+	if (input.scroll != 0.0f)
+	{
+		changeCameraMovement(input.scroll);
+	}
+	moveCamera(input.keys, (GLfloat)simulationStep);
+}
+
+CameraState captureCameraState()
+{
+	CameraState state;
+	state.position = cameraPosition;
+	state.front = cameraFront;
+	return state;
+}
+
+// Blend the last two ticks; alpha is how far the render time is past the previous tick
+CameraState interpolateCameraState(const CameraState& previous, const CameraState& current, float alpha)
+{
+	CameraState state;
+	state.position = previous.position + (current.position - previous.position) * alpha;
+	state.front = glm::normalize(previous.front + (current.front - previous.front) * alpha);
+	return state;
+}
+
+// lookAt functin used to create view matrix that transforms all world coordinates to view space
+glm::mat4 computeViewMatrix()
+{
+	return glm::lookAt(cameraPosition, cameraPosition + cameraFront, cameraUp);
+}
+
+glm::mat4 computeViewMatrix(const CameraState& state)
+{
+	return glm::lookAt(state.position, state.position + state.front, cameraUp);
+}
+
+// Allows user to change view of scene between orthographic (2D) and perspective (3D) views
+glm::mat4 computeProjectionMatrix(int width, int height)
+{
+	return computeProjectionMatrix(width, height, fov, perspective, reverseDepth);
+}
+
+glm::mat4 computeProjectionMatrix(int width, int height, GLfloat fovDegrees, bool perspectiveLens, bool reverseDepthLens)
+{
+	if (perspectiveLens)
+	{
+		if (reverseDepthLens)
+		{
+			return reverseInfinitePerspective(glm::radians(fovDegrees), (GLfloat)width / (GLfloat)height, 0.1f);
+		}
+		return glm::perspective(glm::radians(fovDegrees), (GLfloat)width / (GLfloat)height, 0.1f, 100.0f);
+	}
+
+	float scale = 100;
+	glm::mat4 ortho = glm::ortho(-((float)width / scale), (float)width / scale, -(float)height / scale, ((float)height / scale), -50.0f, 50.0f);
+	if (reverseDepthLens)
+	{
+		// Float depth keeps a much deeper box precise; map it to [0, 1] with the near side at 1
+		const float depthRange = 5000.0f;
+		ortho[2][2] = 1.0f / (2.0f * depthRange);
+		ortho[3][2] = 0.5f;
+	}
+	return ortho;
+}
+
+glm::mat4 reverseInfinitePerspective(GLfloat fovRadians, GLfloat aspect, GLfloat nearPlane)
+{
+	// Clip z is the constant near distance and w the view depth, so depth = near / distance
+	float focal = 1.0f / tan(fovRadians * 0.5f);
+	glm::mat4 projection(0.0f);
+	projection[0][0] = focal / aspect;
+	projection[1][1] = focal;
+	projection[2][3] = -1.0f;
+	projection[3][2] = nearPlane;
+	return projection;
+}
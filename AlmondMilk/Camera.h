@@ -0,0 +1,69 @@
+#pragma once
+#include <GL/glew.h>        // GLEW library
+
+// GLM Libraries
+#include <glm/glm.hpp> 
+
+// Camera attributes shared by the interactive loop and the benchmarks
+extern glm::vec3 cameraPosition;
+extern glm::vec3 target;
+extern glm::vec3 cameraDirection;
+extern glm::vec3 worldUp;
+extern glm::vec3 cameraRight;
+extern glm::vec3 cameraUp;
+extern glm::vec3 cameraFront;
+
+extern GLfloat yaw, pitch;		// Orientation in degrees
+extern GLfloat fov;				// Field of view in degrees
+extern bool perspective;		// boolean to change between perspective and orthographic
+extern bool reverseDepth;		// Reverse-Z depth with an infinite far plane instead of standard depth
+extern GLfloat cameraMovement;	// Movement speed set with the scroll wheel
+extern GLfloat cameraSpeed;		// Distance moved this frame
+
+// Movement keys held down, combined as bit flags
+enum CameraKeys
+{
+	MoveForward = 1 << 0,		// 'W'
+	MoveBackward = 1 << 1,		// 'S'
+	MoveLeft = 1 << 2,			// 'A'
+	MoveRight = 1 << 3,			// 'D'
+	MoveDown = 1 << 4,			// 'Q'
+	MoveUp = 1 << 5,			// 'E'
+	ResetCamera = 1 << 6		// 'F'
+};
+
+// Input collected between two simulation ticks
+struct CameraInput
+{
+	unsigned int keys = 0;			// CameraKeys held down
+	GLfloat xTurn = 0.0f;			// Cursor offset in pixels since the last tick
+	GLfloat yTurn = 0.0f;
+	GLfloat scroll = 0.0f;			// Scroll wheel offset since the last tick
+};
+
+// Camera pose at one simulation tick, used to interpolate between ticks when rendering
+struct CameraState
+{
+	glm::vec3 position;
+	glm::vec3 front;
+};
+
+const double simulationStep = 1.0 / 120.0;		// Fixed camera simulation rate of 120 Hz
+
+void initCamera();										// Function to reset camera
+void moveCamera(unsigned int keys, GLfloat deltaTime);	// WASD/QE movement for one frame
+void turnCamera(GLfloat xOffset, GLfloat yOffset);		// Mouse look from cursor offset in pixels
+void changeCameraMovement(GLfloat yOffset);				// Scroll wheel speed change
+void stepCamera(const CameraInput& input);				// Advance camera by one simulationStep tick
+
+CameraState captureCameraState();
+CameraState interpolateCameraState(const CameraState& previous, const CameraState& current, float alpha);
+
+glm::mat4 computeViewMatrix();
+glm::mat4 computeViewMatrix(const CameraState& state);
+glm::mat4 computeProjectionMatrix(int width, int height);
+glm::mat4 computeProjectionMatrix(int width, int height, GLfloat fovDegrees, bool perspectiveLens, bool reverseDepthLens = false);
+
+// Perspective projection for reverse-Z with [0, 1] clip depth: depth is 1 at the near plane and falls towards 0
+// at infinity, so there is no far plane to clip against
+glm::mat4 reverseInfinitePerspective(GLfloat fovRadians, GLfloat aspect, GLfloat nearPlane);
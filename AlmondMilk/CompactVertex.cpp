@@ -0,0 +1,70 @@
+#include "CompactVertex.h"
+#include "Primitives.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+QuantizedMesh quantizeMesh(const IndexedMesh& mesh)
+{
+	QuantizedMesh quantized;
+	quantized.indices = mesh.indices;
+	GLsizei vertexCount = mesh.vertexCount();
+	if (vertexCount == 0)
+	{
+		return quantized;
+	}
+
+	// Find mesh bounding box
+	glm::vec3 boundsMin(mesh.vertices[0], mesh.vertices[1], mesh.vertices[2]);
+	glm::vec3 boundsMax = boundsMin;
+	for (GLsizei v = 1; v < vertexCount; v++)
+	{
+		const GLfloat* vertex = &mesh.vertices[v * floatsPerVertex];
+		glm::vec3 position(vertex[0], vertex[1], vertex[2]);
+		boundsMin = glm::min(boundsMin, position);
+		boundsMax = glm::max(boundsMax, position);
+	}
+	quantized.dequantOffset = boundsMin;
+	quantized.dequantScale = boundsMax - boundsMin;
+
+	quantized.vertices.resize(vertexCount);
+	for (GLsizei v = 0; v < vertexCount; v++)
+	{
+		const GLfloat* vertex = &mesh.vertices[v * floatsPerVertex];
+		CompactVertex& packed = quantized.vertices[v];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			// Flat axes (extent 0) always decode to the minimum
+			float extent = quantized.dequantScale[axis];
+			float normalized = extent > 0.0f ? (vertex[axis] - boundsMin[axis]) / extent : 0.0f;
+			packed.position[axis] = (GLushort)lround(min(max(normalized, 0.0f), 1.0f) * 65535.0f);
+
+			float decoded = packed.position[axis] / 65535.0f * extent + boundsMin[axis];
+			quantized.maxPositionError = max(quantized.maxPositionError, fabs(decoded - vertex[axis]));
+		}
+		packed.position[3] = 0;
+
+		for (int channel = 0; channel < 3; channel++)
+		{
+			float color = min(max(vertex[3 + channel], 0.0f), 1.0f);
+			packed.color[channel] = (GLubyte)lround(color * 255.0f);
+			quantized.maxColorError = max(quantized.maxColorError, fabs(packed.color[channel] / 255.0f - vertex[3 + channel]));
+		}
+		packed.color[3] = 255;
+	}
+	return quantized;
+}
+
+void printQuantizationStats(const char* name, const IndexedMesh& mesh, const QuantizedMesh& quantized)
+{
+	size_t floatBytes = mesh.vertices.size() * sizeof(GLfloat);
+	size_t compactBytes = quantized.vertices.size() * sizeof(CompactVertex);
+
+	cout << name << ": compact vertices " << floatBytes << " -> " << compactBytes << " bytes (saved "
+		<< floatBytes - compactBytes << "), max position error " << quantized.maxPositionError
+		<< ", max color error " << quantized.maxColorError << endl;
+}
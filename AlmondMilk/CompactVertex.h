@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <GL/glew.h>        // GLEW library
+
+// GLM Libraries
+#include <glm/glm.hpp> 
+
+#include "MeshBuilder.h"
+
+// Compact vertex: 16-bit normalized position inside the mesh bounding box and RGBA8 color (12 bytes)
+struct CompactVertex
+{
+	GLushort position[4];	// x, y, z quantized to [0, 65535]; fourth component pads to 4-byte alignment
+	GLubyte color[4];		// r, g, b, a quantized to [0, 255]
+};
+static_assert(sizeof(CompactVertex) == 12, "CompactVertex must stay 12 bytes");
+
+// Indexed mesh with quantized vertices plus the values the shader needs to decode them
+struct QuantizedMesh
+{
+	std::vector<CompactVertex> vertices;
+	std::vector<GLuint> indices;
+	glm::vec3 dequantScale = glm::vec3(1.0f);	// Bounding box extent: position = normalized * scale + offset
+	glm::vec3 dequantOffset = glm::vec3(0.0f);	// Bounding box minimum
+	float maxPositionError = 0.0f;				// Largest reconstruction error of any position component
+	float maxColorError = 0.0f;					// Largest reconstruction error of any color component
+};
+
+// Quantize positions relative to the mesh bounding box and pack colors to RGBA8
+QuantizedMesh quantizeMesh(const IndexedMesh& mesh);
+
+// Print reconstruction error and memory saved by the compact layout
+void printQuantizationStats(const char* name, const IndexedMesh& mesh, const QuantizedMesh& quantized);
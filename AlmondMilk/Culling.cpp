@@ -0,0 +1,200 @@
+#include "Culling.h"
+
+#include <algorithm>
+
+// Objects per leaf; small leaves cull tighter, large leaves traverse faster
+const int maxLeafObjects = 4;
+
+AABB transformAABB(const AABB& box, const glm::mat4& model)
+{
+	// Arvo's method: accumulate min/max of every matrix entry times the box extents
+	AABB result;
+	result.min = glm::vec3(model[3]);
+	result.max = result.min;
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			float a = model[column][row] * box.min[column];
+			float b = model[column][row] * box.max[column];
+			result.min[row] += std::min(a, b);
+			result.max[row] += std::max(a, b);
+		}
+	}
+	return result;
+}
+
+Frustum extractFrustum(const glm::mat4& viewProjection)
+{
+	// Gribb/Hartmann: planes are sums and differences of the matrix rows
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+	{
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+	}
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0];		// Left
+	frustum.planes[1] = rows[3] - rows[0];		// Right
+	frustum.planes[2] = rows[3] + rows[1];		// Bottom
+	frustum.planes[3] = rows[3] - rows[1];		// Top
+	frustum.planes[4] = rows[3] + rows[2];		// Near
+	frustum.planes[5] = rows[3] - rows[2];		// Far
+	return frustum;
+}
+
+CullResult testAABB(const Frustum& frustum, const AABB& box)
+{
+	CullResult result = Inside;
+	for (int p = 0; p < 6; p++)
+	{
+		const glm::vec4& plane = frustum.planes[p];
+
+		// Corner furthest along the plane normal; if it is behind the plane the whole box is
+		glm::vec3 positive(plane.x >= 0.0f ? box.max.x : box.min.x,
+			plane.y >= 0.0f ? box.max.y : box.min.y,
+			plane.z >= 0.0f ? box.max.z : box.min.z);
+		if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+		{
+			return Outside;
+		}
+
+		// Corner furthest against the normal decides whether the box straddles the plane
+		glm::vec3 negative(plane.x >= 0.0f ? box.min.x : box.max.x,
+			plane.y >= 0.0f ? box.min.y : box.max.y,
+			plane.z >= 0.0f ? box.min.z : box.max.z);
+		if (glm::dot(glm::vec3(plane), negative) + plane.w < 0.0f)
+		{
+			result = Intersecting;
+		}
+	}
+	return result;
+}
+
+void BVH::build(const std::vector<AABB>& objectBounds)
+{
+	bounds = objectBounds;
+	nodes.clear();
+	objectIds.resize(bounds.size());
+	centers.resize(bounds.size());
+	for (size_t i = 0; i < bounds.size(); i++)
+	{
+		objectIds[i] = (int)i;
+		centers[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+	}
+
+	if (!bounds.empty())
+	{
+		nodes.reserve(4 * bounds.size() / maxLeafObjects + 1);
+		nodes.resize(1);
+		buildNode(0, 0, (int)bounds.size());
+	}
+	std::vector<glm::vec3>().swap(centers);
+}
+
+// Fill node and its subtree over objectIds[first, first + count)
+void BVH::buildNode(int index, int first, int count)
+{
+	AABB nodeBounds = bounds[objectIds[first]];
+	for (int i = first + 1; i < first + count; i++)
+	{
+		nodeBounds.min = glm::min(nodeBounds.min, bounds[objectIds[i]].min);
+		nodeBounds.max = glm::max(nodeBounds.max, bounds[objectIds[i]].max);
+	}
+	nodes[index].bounds = nodeBounds;
+	nodes[index].first = first;
+	nodes[index].count = count;
+	nodes[index].left = -1;
+
+	if (count <= maxLeafObjects)
+	{
+		return;
+	}
+
+	// Median split along the longest axis
+	glm::vec3 extent = nodeBounds.max - nodeBounds.min;
+	int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+	int half = count / 2;
+	std::nth_element(objectIds.begin() + first, objectIds.begin() + first + half, objectIds.begin() + first + count,
+		[this, axis](int a, int b) { return centers[a][axis] < centers[b][axis]; });
+
+	// Children are allocated next to each other so only the first needs storing
+	int left = (int)nodes.size();
+	nodes.resize(nodes.size() + 2);
+	nodes[index].left = left;
+	buildNode(left, first, half);
+	buildNode(left + 1, first + half, count - half);
+}
+
+void BVH::cull(const Frustum& frustum, std::vector<int>& visible, int root) const
+{
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	int stack[64];
+	int top = 0;
+	stack[top++] = root;
+	while (top > 0)
+	{
+		const Node& node = nodes[stack[--top]];
+		CullResult result = testAABB(frustum, node.bounds);
+		if (result == Outside)
+		{
+			continue;	// Whole subtree hidden
+		}
+
+		if (result == Inside)
+		{
+			// Whole subtree visible; no further tests needed
+			visible.insert(visible.end(), objectIds.begin() + node.first, objectIds.begin() + node.first + node.count);
+		}
+		else if (node.left < 0)
+		{
+			// Leaf straddling the frustum: test each object
+			for (int i = node.first; i < node.first + node.count; i++)
+			{
+				if (testAABB(frustum, bounds[objectIds[i]]) != Outside)
+				{
+					visible.push_back(objectIds[i]);
+				}
+			}
+		}
+		else
+		{
+			stack[top++] = node.left;
+			stack[top++] = node.left + 1;
+		}
+	}
+}
+
+void BVH::subtrees(size_t maxCount, std::vector<int>& roots) const
+{
+	roots.clear();
+	if (nodes.empty())
+	{
+		return;
+	}
+	roots.push_back(0);
+	while (roots.size() < maxCount)
+	{
+		// Replace the inner node covering the most objects by its two children
+		int largest = -1;
+		for (size_t i = 0; i < roots.size(); i++)
+		{
+			const Node& node = nodes[roots[i]];
+			if (node.left >= 0 && (largest < 0 || node.count > nodes[roots[largest]].count))
+			{
+				largest = (int)i;
+			}
+		}
+		if (largest < 0)
+		{
+			break;		// Only leaves left
+		}
+		int left = nodes[roots[largest]].left;
+		roots[largest] = left;
+		roots.insert(roots.begin() + largest + 1, left + 1);
+	}
+}
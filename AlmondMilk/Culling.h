@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+
+// GLM Libraries
+#include <glm/glm.hpp> 
+
+// Axis-aligned bounding box
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+// Bounds of a model-space box after transforming it by a model matrix
+AABB transformAABB(const AABB& box, const glm::mat4& model);
+
+// Six clip planes (left, right, bottom, top, near, far) with normals pointing inside
+struct Frustum
+{
+	glm::vec4 planes[6];
+};
+
+// Extract frustum planes from a combined projection * view matrix
+Frustum extractFrustum(const glm::mat4& viewProjection);
+
+enum CullResult
+{
+	Outside,
+	Intersecting,
+	Inside
+};
+
+CullResult testAABB(const Frustum& frustum, const AABB& box);
+
+// Bounding volume hierarchy over object bounds; culls whole subtrees against the frustum
+class BVH
+{
+public:
+	void build(const std::vector<AABB>& objectBounds);
+
+	// Append ids of every object whose bounds touch the frustum, searching the subtree below 'root'
+	void cull(const Frustum& frustum, std::vector<int>& visible, int root = 0) const;
+
+	// Split the tree into at most 'maxCount' disjoint subtrees covering every object, largest split first,
+	// so threads can cull them independently. Together they find the same objects as cull(), in another order.
+	void subtrees(size_t maxCount, std::vector<int>& roots) const;
+
+	size_t nodeCount() const { return nodes.size(); }
+
+private:
+	struct Node
+	{
+		AABB bounds;
+		int left;				// Index of first child; -1 for leaves (second child follows the first)
+		int first;				// First entry of objectIds covered by this subtree
+		int count;				// Number of objects covered by this subtree
+	};
+
+	void buildNode(int index, int first, int count);
+
+	std::vector<Node> nodes;
+	std::vector<int> objectIds;			// Objects ordered so every subtree covers a contiguous range
+	std::vector<AABB> bounds;			// Copy of object bounds used during build
+	std::vector<glm::vec3> centers;		// Object centers used to split nodes
+};
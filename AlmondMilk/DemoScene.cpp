@@ -0,0 +1,113 @@
+#include "DemoScene.h"
+#include "CompactVertex.h"
+#include "MeshBuilder.h"
+#include "Primitives.h"
+
+#include <cmath>
+#include <iostream>
+
+// GLM Libraries
+#include <glm/gtc/matrix_transform.hpp> 
+
+using namespace std;
+
+static const glm::vec3 spinAxis(0.0f, 1.0f, 0.0f);
+
+DemoMeshes addDemoMeshes(ScenePool& pool, bool verbose)
+{
+	// Weld duplicate vertices, build index buffers and reorder triangles for the vertex cache
+	IndexedMesh planeMesh = buildIndexedMesh(planeVertices, planeVertexCount);
+	IndexedMesh milkCubeMesh = buildIndexedMesh(milkCubeVertices, milkCubeVertexCount);
+	IndexedMesh milkCPyramidMesh = buildIndexedMesh(milkCPyramidVertices, milkCPyramidVertexCount);
+	IndexedMesh donutBoxMesh = buildIndexedMesh(donutBoxVertices, donutBoxVertexCount);
+	if (verbose)
+	{
+		printMeshStats("Plane", planeMesh);
+		printMeshStats("Almond Milk base", milkCubeMesh);
+		printMeshStats("Almond Milk top", milkCPyramidMesh);
+		printMeshStats("Donut box", donutBoxMesh);
+		if (pool.compactVertices())
+		{
+			printQuantizationStats("Plane", planeMesh, quantizeMesh(planeMesh));
+			printQuantizationStats("Almond Milk base", milkCubeMesh, quantizeMesh(milkCubeMesh));
+			printQuantizationStats("Almond Milk top", milkCPyramidMesh, quantizeMesh(milkCPyramidMesh));
+			printQuantizationStats("Donut box", donutBoxMesh, quantizeMesh(donutBoxMesh));
+		}
+	}
+
+	// Pack every primitive into the shared scene geometry pool
+	DemoMeshes meshes;
+	meshes.plane = pool.addMesh(planeMesh);					// PLANE
+	meshes.milkCube = pool.addMesh(milkCubeMesh);			// Almond Milk base cube
+	meshes.milkCPyramid = pool.addMesh(milkCPyramidMesh);	// Almond Milk top pyramids
+	meshes.donutBox = pool.addMesh(donutBoxMesh);			// Donut box
+
+	// Procedural shapes, every level generated in parallel
+	vector<ShapeDesc> shapes;
+	shapes.push_back(torusShape(0.6f, 0.25f, 48, glm::vec3(0.85f, 0.55f, 0.3f)));			// Donut
+	shapes.push_back(cylinderShape(0.1f, 2.5f, 16, glm::vec3(1.0f, 1.0f, 1.0f)));			// Straw
+	vector<LodChain> chains = addLodChains(pool, shapes, demoLodLevels);
+	meshes.donut = chains[0];
+	meshes.straw = chains[1];
+
+	// Materials group draws in the sort order: carton, donut box, donuts, straw
+	pool.setMeshState(meshes.milkCube, 1, false);
+	pool.setMeshState(meshes.milkCPyramid, 1, false);
+	pool.setMeshState(meshes.donutBox, 2, false);
+	for (int lod = 0; lod < demoLodLevels; lod++)
+	{
+		pool.setMeshState(meshes.donut.meshes[lod], 3, false);
+		pool.setMeshState(meshes.straw.meshes[lod], 4, false);
+	}
+
+	// Plane, carton and donut box hide what is behind them; drawn depth-only first with occlusion culling
+	pool.setMeshOccluder(meshes.plane, true);
+	pool.setMeshOccluder(meshes.milkCube, true);
+	pool.setMeshOccluder(meshes.donutBox, true);
+	if (verbose)
+	{
+		for (int lod = 0; lod < demoLodLevels; lod++)
+		{
+			cout << "Donut LOD " << lod << ": " << pool.mesh(meshes.donut.meshes[lod]).indexCount / 3 << " triangles" << endl;
+		}
+	}
+	return meshes;
+}
+
+void populateDemoScene(Scene& scene, const ScenePool& pool, const DemoMeshes& meshes, int extraDonutBoxes)
+{
+	// Place objects in the scene; each keeps its own model matrix
+	glm::mat4 modelMatrix = glm::mat4(1.0f); // Declare identity matrix
+	modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 5.0f, 0.0f)); // Translate on y axis
+	modelMatrix = glm::rotate(modelMatrix, glm::degrees(0.0f), glm::vec3(1.0f, 0.3f, 0.5f)); // Rotate along y axis
+	scene.addObject(meshes.plane, modelMatrix);
+
+	modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 5.0f, 0.0f));
+	scene.addObject(meshes.milkCube, modelMatrix);			// Almond milk base
+	scene.addObject(meshes.milkCPyramid, modelMatrix);		// Almond milk top
+	scene.addObject(meshes.donutBox, modelMatrix);			// Donut box
+
+	int donut = scene.addLodChain(meshes.donut);
+	int straw = scene.addLodChain(meshes.straw);
+	scene.addLodObject(donut, glm::translate(glm::mat4(1.0f), glm::vec3(2.75f, 1.25f, 0.25f)));		// Donut on the donut box
+	scene.addLodObject(straw, glm::translate(glm::mat4(1.0f), glm::vec3(-1.0f, 4.0f, -1.0f)));		// Straw in the carton
+
+	// Grid of spinning donut box copies behind the plane, transformed by the SIMD kernel and drawn by the same instanced draw
+	int gridSide = (int)ceil(sqrt((double)extraDonutBoxes));
+	for (int i = 0; i < extraDonutBoxes; i++)
+	{
+		glm::vec3 offset((i % gridSide - gridSide / 2) * 5.0f, 5.0f, -(i / gridSide + 2) * 5.0f);
+		scene.addDynamicObject(pool, meshes.donutBox, offset, spinAxis, 0.0f, glm::vec3(1.0f));
+		scene.addLodObject(donut, glm::translate(glm::mat4(1.0f), offset + glm::vec3(0.0f, -3.0f, 0.0f)));
+	}
+}
+
+void animateDemoScene(Scene& scene, float time)
+{
+	// Spin each donut box copy at its own phase
+	TransformSoA& spinning = scene.dynamicTransforms();
+	for (size_t i = 0; i < spinning.size(); i++)
+	{
+		spinning.setRotation(i, spinAxis, time + i * 0.1f);
+	}
+}
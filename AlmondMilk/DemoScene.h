@@ -0,0 +1,28 @@
+#pragma once
+#include "Scene.h"
+#include "ScenePool.h"
+
+// Levels of detail generated for each procedural shape
+const int demoLodLevels = 4;
+
+// Pool ids of the four primitives and the procedural shapes in the demo scene
+struct DemoMeshes
+{
+	int plane;
+	int milkCube;
+	int milkCPyramid;
+	int donutBox;
+	LodChain donut;
+	LodChain straw;
+};
+
+// Weld, index and add every primitive to the pool and generate the procedural shapes; the caller uploads it.
+// Prints mesh statistics when verbose.
+DemoMeshes addDemoMeshes(ScenePool& pool, bool verbose);
+
+// Plane, almond milk carton with a straw and donut box with a donut, plus a grid of extra spinning donut boxes
+// behind the plane, each with a donut hovering over it
+void populateDemoScene(Scene& scene, const ScenePool& pool, const DemoMeshes& meshes, int extraDonutBoxes);
+
+// Turn the spinning donut boxes to their angle at 'time' seconds
+void animateDemoScene(Scene& scene, float time);
@@ -0,0 +1,104 @@
+#include "DrawSort.h"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+using namespace std;
+
+// Field positions indexed by pass
+static const int passShift = 62;
+static const int programShift[2] = { 52, 42 }, vertexArrayShift[2] = { 42, 32 }, materialShift[2] = { 30, 20 }, depthShift[2] = { 20, 52 };
+static const DrawKey programMask = 0x3FF, vertexArrayMask = 0x3FF, materialMask = 0xFFF, depthMask = 0x3FF, meshMask = 0xFFFFF;
+
+DrawKey makeDrawKey(RenderPass pass, GLuint program, GLuint vertexArray, GLuint material, unsigned int depthBucket, int mesh)
+{
+	return (DrawKey)pass << passShift
+		| (program & programMask) << programShift[pass]
+		| (vertexArray & vertexArrayMask) << vertexArrayShift[pass]
+		| (material & materialMask) << materialShift[pass]
+		| (depthBucket & depthMask) << depthShift[pass]
+		| ((DrawKey)mesh & meshMask);
+}
+
+RenderPass keyPass(DrawKey key) { return (RenderPass)(key >> passShift); }
+GLuint keyProgram(DrawKey key) { return (GLuint)(key >> programShift[keyPass(key)] & programMask); }
+GLuint keyVertexArray(DrawKey key) { return (GLuint)(key >> vertexArrayShift[keyPass(key)] & vertexArrayMask); }
+GLuint keyMaterial(DrawKey key) { return (GLuint)(key >> materialShift[keyPass(key)] & materialMask); }
+unsigned int keyDepthBucket(DrawKey key) { return (unsigned int)(key >> depthShift[keyPass(key)] & depthMask); }
+int keyMesh(DrawKey key) { return (int)(key & meshMask); }
+
+unsigned int depthBucket(float distance, float nearest, float farthest, RenderPass pass)
+{
+	int buckets = pass == TransparentPass ? transparentDepthBucketCount : depthBucketCount;
+	float t = distance > nearest ? log(distance / nearest) / log(farthest / nearest) : 0.0f;
+	int bucket = (int)(t * buckets);
+	bucket = bucket < 0 ? 0 : (bucket >= buckets ? buckets - 1 : bucket);
+	return pass == TransparentPass ? buckets - 1 - bucket : (unsigned int)bucket;
+}
+
+void radixSortKeys(DrawKey* keys, unsigned int* values, size_t count, DrawKey* keyScratch, unsigned int* valueScratch)
+{
+	if (count < 2)
+	{
+		return;
+	}
+	DrawKey* sortedKeys = keys;
+	unsigned int* sortedValues = values;
+
+	// One histogram per byte, all filled in a single pass over the keys
+	size_t histograms[8][256];
+	memset(histograms, 0, sizeof(histograms));
+	for (size_t i = 0; i < count; i++)
+	{
+		DrawKey key = keys[i];
+		for (int byte = 0; byte < 8; byte++)
+		{
+			histograms[byte][(key >> (byte * 8)) & 0xFF]++;
+		}
+	}
+
+	for (int byte = 0; byte < 8; byte++)
+	{
+		size_t* histogram = histograms[byte];
+		if (histogram[(keys[0] >> (byte * 8)) & 0xFF] == count)
+		{
+			continue;		// Every key has this byte; the pass would not move anything
+		}
+
+		// Counts to first positions, then scatter in key order, which keeps the sort stable
+		size_t offset = 0;
+		for (int digit = 0; digit < 256; digit++)
+		{
+			size_t digitCount = histogram[digit];
+			histogram[digit] = offset;
+			offset += digitCount;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			size_t target = histogram[(keys[i] >> (byte * 8)) & 0xFF]++;
+			keyScratch[target] = keys[i];
+			valueScratch[target] = values[i];
+		}
+		swap(keys, keyScratch);
+		swap(values, valueScratch);
+	}
+
+	// An odd number of passes left the result in the caller's scratch arrays
+	if (keys != sortedKeys)
+	{
+		memcpy(sortedKeys, keys, count * sizeof(DrawKey));
+		memcpy(sortedValues, values, count * sizeof(unsigned int));
+	}
+}
+
+unsigned int countStateChanges(const DrawKey* keys, size_t count)
+{
+	auto state = [](DrawKey key) { return key & ~(depthMask << depthShift[keyPass(key)]); };
+	unsigned int changes = 0;
+	for (size_t i = 1; i < count; i++)
+	{
+		changes += state(keys[i]) != state(keys[i - 1]);
+	}
+	return changes;
+}
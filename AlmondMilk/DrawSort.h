@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <GL/glew.h>        // GLEW library
+
+// Render passes in submission order
+enum RenderPass
+{
+	OpaquePass = 0,			// Front to back, so the depth test rejects hidden fragments early
+	TransparentPass = 1		// Back to front, blended over the opaque scene
+};
+
+// 64-bit draw sort key; sorting keys ascending groups opaque draws by state, most expensive switch first, and
+// orders transparent draws by depth before state, since blending needs them back to front across the whole pass:
+//   opaque:      bits 63-62 pass | 61-52 program | 51-42 vertex array | 41-30 material | 29-20 depth bucket | 19-0 mesh
+//   transparent: bits 63-62 pass | 61-52 depth bucket | 51-42 program | 41-32 vertex array | 31-20 material | 19-0 mesh
+typedef unsigned long long DrawKey;
+
+DrawKey makeDrawKey(RenderPass pass, GLuint program, GLuint vertexArray, GLuint material, unsigned int depthBucket, int mesh);
+RenderPass keyPass(DrawKey key);
+GLuint keyProgram(DrawKey key);
+GLuint keyVertexArray(DrawKey key);
+GLuint keyMaterial(DrawKey key);
+unsigned int keyDepthBucket(DrawKey key);
+int keyMesh(DrawKey key);
+
+// Coarse opaque buckets keep instanced runs long: objects of one mesh in the same bucket stay one draw command.
+// Transparent buckets are fine enough that draws sharing one are at nearly the same distance.
+const unsigned int depthBucketCount = 16;
+const unsigned int transparentDepthBucketCount = 1024;
+
+// Bucket of a view distance, log-spaced between the nearest and farthest distance sorted so nearby objects get
+// finer buckets. Increases with distance for the opaque pass and decreases for the transparent pass.
+unsigned int depthBucket(float distance, float nearest, float farthest, RenderPass pass);
+
+// Sort keys ascending, moving values along. Stable LSD radix sort over bytes; bytes that are the same in every
+// key (unused programs, vertex arrays, materials) are skipped. Scratch arrays hold 'count' entries each; the
+// sorted keys and values always end up back in 'keys' and 'values'.
+void radixSortKeys(DrawKey* keys, unsigned int* values, size_t count, DrawKey* keyScratch, unsigned int* valueScratch);
+
+// GL state changes when drawing in key order: pass, program, vertex array, material or mesh switches.
+// Each one ends an instanced run; depth bucket changes alone do not count.
+unsigned int countStateChanges(const DrawKey* keys, size_t count);
@@ -0,0 +1,131 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+constexpr float ResolutionController::scaleStep;
+
+ResolutionController::ResolutionController(double budgetMs, int latencyFrames, float minScale, float maxScale)
+	: budget(budgetMs), latency(latencyFrames), minimum(minScale), maximum(maxScale), current(maxScale)
+{
+}
+
+double ResolutionController::averageMs() const
+{
+	double total = 0.0;
+	for (int i = 0; i < sampleCount; i++)
+	{
+		total += samples[i];
+	}
+	return sampleCount ? total / sampleCount : 0.0;
+}
+
+float ResolutionController::update(double frameMs)
+{
+	periodStats.frames++;
+	periodStats.budgetHits += frameMs <= budget;
+	periodStats.totalMs += frameMs;
+	if (skip > 0)
+	{
+		skip--;
+		return current;
+	}
+	samples[nextSample] = frameMs;
+	nextSample = (nextSample + 1) % window;
+	sampleCount = min(sampleCount + 1, window);
+	if (sampleCount < window)
+	{
+		return current;
+	}
+
+	double average = averageMs();
+	bool over = average > budget * 0.95;
+	bool under = average < budget * 0.7;
+	if (!over && !(under && current < maximum))
+	{
+		return current;
+	}
+
+	// Time follows the pixel count, the square of the scale; rising is limited to two steps at a time
+	float wanted = current * (float)sqrt(budget * 0.85 / max(average, 0.001));
+	wanted = round(wanted / scaleStep) * scaleStep;
+	if (over)
+	{
+		wanted = min(wanted, current - scaleStep);
+	}
+	else
+	{
+		wanted = min(wanted, current + 2.0f * scaleStep);
+	}
+	wanted = max(minimum, min(maximum, wanted));
+	if (wanted != current)
+	{
+		current = wanted;
+		sampleCount = 0;
+		nextSample = 0;
+		skip = latency;
+		periodStats.scaleChanges++;
+	}
+	return current;
+}
+
+bool FrameGpuTimer::create()
+{
+	if (!GLEW_VERSION_3_3 && !GLEW_ARB_timer_query)
+	{
+		return false;
+	}
+	glGenQueries(pairCount * 2, queries);
+	return true;
+}
+
+void FrameGpuTimer::destroy()
+{
+	if (queries[0])
+	{
+		glDeleteQueries(pairCount * 2, queries);
+	}
+	fill(queries, queries + pairCount * 2, 0u);
+	fill(pending, pending + pairCount, false);
+}
+
+void FrameGpuTimer::begin()
+{
+	// Still unread after two frames: drop it rather than wait
+	pending[current] = false;
+	glQueryCounter(queries[current * 2], GL_TIMESTAMP);
+}
+
+void FrameGpuTimer::end()
+{
+	glQueryCounter(queries[current * 2 + 1], GL_TIMESTAMP);
+	pending[current] = true;
+	current = (current + 1) % pairCount;
+}
+
+bool FrameGpuTimer::read(double& ms)
+{
+	for (int i = 0; i < pairCount && !pending[oldest]; i++)
+	{
+		oldest = (oldest + 1) % pairCount;
+	}
+	if (!pending[oldest])
+	{
+		return false;
+	}
+	GLint available = 0;
+	glGetQueryObjectiv(queries[oldest * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+	{
+		return false;
+	}
+	GLuint64 start = 0, end = 0;
+	glGetQueryObjectui64v(queries[oldest * 2], GL_QUERY_RESULT, &start);
+	glGetQueryObjectui64v(queries[oldest * 2 + 1], GL_QUERY_RESULT, &end);
+	pending[oldest] = false;
+	oldest = (oldest + 1) % pairCount;
+	ms = (end - start) / 1.0e6;
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <GL/glew.h>        // GLEW library
+
+// Scale decisions of one reporting period
+struct ResolutionStats
+{
+	unsigned int frames = 0;			// Measurements received
+	unsigned int budgetHits = 0;		// Measurements within the budget
+	double totalMs = 0.0;				// Sum of the measurements, including those skipped after a change
+	unsigned int scaleChanges = 0;
+};
+
+// Picks the render scale (fraction of the window's width and height) from measured frame times. A rolling mean
+// over the last 'window' frames is compared with the budget: above 95% of it the scale drops, below 70% it
+// rises, and in between it holds. Each change aims the mean at 85% of the budget, assuming time grows with the
+// pixel count, and scales move in 1/16 steps. Measurements arrive 'latencyFrames' late, so that many after each
+// change still belong to the old scale and are skipped.
+class ResolutionController
+{
+public:
+	static const int window = 8;
+	static constexpr float scaleStep = 1.0f / 16.0f;
+
+	ResolutionController(double budgetMs, int latencyFrames = 2, float minScale = 0.5f, float maxScale = 1.0f);
+
+	float update(double frameMs);		// Feed one measurement; returns the scale for the next frame
+	float scale() const { return current; }
+	double budgetMs() const { return budget; }
+	double averageMs() const;			// Rolling mean of the measurements since the last change
+	const ResolutionStats& stats() const { return periodStats; }
+	void clearStats() { periodStats = ResolutionStats(); }
+
+private:
+	double budget;
+	int latency;
+	float minimum, maximum;
+	float current;
+	double samples[window];
+	int sampleCount = 0;				// Measurements at the current scale, up to 'window'
+	int nextSample = 0;
+	int skip = 0;						// Late measurements of the previous scale still to come
+	ResolutionStats periodStats;
+};
+
+// GPU time of one part of each frame from timestamp query pairs (GL_TIME_ELAPSED cannot nest with the profiler's
+// scopes). Three pairs rotate, so results are read about two frames later and reading never waits for the GPU.
+class FrameGpuTimer
+{
+public:
+	bool create();					// False without timer queries (GL 3.3 or ARB_timer_query)
+	void destroy();
+	void begin();
+	void end();
+	bool read(double& ms);			// Oldest finished measurement not read yet, if there is one
+
+private:
+	static const int pairCount = 3;
+	GLuint queries[pairCount * 2] = {};
+	bool pending[pairCount] = {};
+	int current = 0;				// Pair recorded this frame
+	int oldest = 0;					// Next pair to read
+};
@@ -0,0 +1,35 @@
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(double step, double maxFrameTime)
+	: tickLength(step), maxFrame(maxFrameTime)
+{
+}
+
+int FixedTimestep::advance(double frameTime)
+{
+	if (frameTime > maxFrame)
+	{
+		frameTime = maxFrame;
+	}
+	if (frameTime < 0.0)
+	{
+		frameTime = 0.0;
+	}
+
+	accumulator += frameTime;
+	int ticksToRun = 0;
+	while (accumulator >= tickLength)
+	{
+		accumulator -= tickLength;
+		ticksToRun++;
+	}
+	tickCount += ticksToRun;
+	return ticksToRun;
+}
+
+float FixedTimestep::alpha() const
+{
+	// Leftover just under one tick can still round up to 1.0f
+	float fraction = (float)(accumulator / tickLength);
+	return fraction < 1.0f ? fraction : 0.99999994f;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+// Turns variable frame times into a whole number of fixed simulation ticks.
+// The time left over is kept for the next frame and exposed as an interpolation factor.
+class FixedTimestep
+{
+public:
+	explicit FixedTimestep(double step, double maxFrameTime = 0.25);
+
+	int advance(double frameTime);		// Add one frame's time; returns the number of ticks to run
+	float alpha() const;				// Fraction of a tick between the last tick and now, in [0, 1)
+	double step() const { return tickLength; }
+	long long ticks() const { return tickCount; }
+
+private:
+	double tickLength;
+	double maxFrame;					// Longer frames are clamped so a stall does not queue hundreds of ticks
+	double accumulator = 0.0;
+	long long tickCount = 0;
+};
@@ -0,0 +1,58 @@
+#include "FrameArena.h"
+
+#include <cstdint>
+
+using namespace std;
+
+FrameArena::FrameArena(size_t bytesPerFrame, int frames)
+{
+	for (int i = 0; i < frames; i++)
+	{
+		regions.emplace_back(new Region());
+		regions.back()->memory.reset(new unsigned char[bytesPerFrame]);
+		regions.back()->capacity = bytesPerFrame;
+	}
+	counters.capacity = bytesPerFrame;
+}
+
+void FrameArena::beginFrame()
+{
+	counters.bytesUsed = regions[current]->used.load(memory_order_relaxed);
+	current = (current + 1) % (int)regions.size();
+
+	Region& region = *regions[current];
+	if (!region.overflow.empty())
+	{
+		// Last time round this region ran out; grow it to that frame's size plus headroom
+		size_t needed = region.used.load(memory_order_relaxed);
+		region.overflow.clear();
+		region.capacity = needed + needed / 2;
+		region.memory.reset(new unsigned char[region.capacity]);
+	}
+	region.used.store(0, memory_order_relaxed);
+	counters.capacity = region.capacity;
+}
+
+// Round an address up to a power of two alignment
+static void* alignPointer(unsigned char* pointer, size_t alignment)
+{
+	uintptr_t address = (uintptr_t)pointer;
+	return (void*)((address + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+	// Reserve the worst-case padding too, so the bump needs no compare-and-swap loop
+	Region& region = *regions[current];
+	size_t size = bytes + alignment - 1;
+	size_t offset = region.used.fetch_add(size, memory_order_relaxed);
+	if (offset + size <= region.capacity)
+	{
+		return alignPointer(region.memory.get() + offset, alignment);
+	}
+
+	lock_guard<mutex> lock(overflowLock);
+	region.overflow.emplace_back(new unsigned char[size]);
+	counters.overflows++;
+	return alignPointer(region.overflow.back().get(), alignment);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Array allocated from a FrameArena; valid until the arena reuses the region it came from
+template <typename T>
+struct ArenaArray
+{
+	T* items = nullptr;
+	size_t count = 0;
+
+	T* data() const { return items; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	T* begin() const { return items; }
+	T* end() const { return items + count; }
+	T& operator[](size_t i) const { return items[i]; }
+};
+
+// Counters for the stats line and the allocation test
+struct ArenaStats
+{
+	size_t bytesUsed = 0;		// Allocated during the last finished frame, including alignment padding
+	size_t capacity = 0;		// Bytes of the region in use
+	size_t overflows = 0;		// Heap blocks taken because a region ran out, since creation
+};
+
+// Linear allocator for data that lives for one frame. Memory is split into one region per frame in flight;
+// beginFrame() moves to the next region and drops everything allocated there 'frames' frames ago, so a list
+// handed to the GL thread stays valid while the next one is built. allocate() is a lock-free bump and may be
+// called from any thread. A region that runs out takes heap blocks for the rest of its frame and is regrown
+// to fit when it is next reused, so once frame sizes settle no frame touches the heap.
+class FrameArena
+{
+public:
+	explicit FrameArena(size_t bytesPerFrame = 1 << 20, int frames = 2);
+
+	// Start a frame in the next region; nothing may still be allocating from the previous one
+	void beginFrame();
+
+	void* allocate(size_t bytes, size_t alignment = 16);
+
+	template <typename T>
+	ArenaArray<T> allocateArray(size_t count)
+	{
+		ArenaArray<T> array;
+		array.items = (T*)allocate(count * sizeof(T), alignof(T));
+		array.count = count;
+		return array;
+	}
+
+	int frames() const { return (int)regions.size(); }
+	const ArenaStats& stats() const { return counters; }
+
+private:
+	struct Region
+	{
+		std::unique_ptr<unsigned char[]> memory;
+		size_t capacity = 0;
+		std::atomic<size_t> used;			// Bytes requested this frame; past capacity once it overflowed
+		std::vector<std::unique_ptr<unsigned char[]>> overflow;		// Guarded by overflowLock
+
+		Region() : used(0) {}
+	};
+
+	std::vector<std::unique_ptr<Region>> regions;
+	int current = 0;
+	std::mutex overflowLock;
+	ArenaStats counters;
+};
@@ -0,0 +1,190 @@
+#include "FramePacing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+const char* vsyncModeName(VsyncMode mode)
+{
+	switch (mode)
+	{
+	case VsyncOff:		return "off";
+	case VsyncOn:		return "on";
+	case VsyncAdaptive:	return "adaptive";
+	}
+	return "unknown";
+}
+
+bool parseVsyncMode(const char* text, VsyncMode& mode)
+{
+	for (VsyncMode candidate : { VsyncOff, VsyncOn, VsyncAdaptive })
+	{
+		if (strcmp(text, vsyncModeName(candidate)) == 0)
+		{
+			mode = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+void LatencyHistogram::add(double ms)
+{
+	int index = min((int)(max(ms, 0.0) / latencyBucketMs), bucketCount - 1);
+	counts[index]++;
+	samples++;
+	totalMs += ms;
+	slowest = max(slowest, ms);
+}
+
+void LatencyHistogram::clear()
+{
+	fill(counts, counts + bucketCount, 0ULL);
+	samples = 0;
+	totalMs = 0.0;
+	slowest = 0.0;
+}
+
+double LatencyHistogram::percentile(double fraction) const
+{
+	unsigned long long needed = (unsigned long long)ceil(fraction * samples);
+	unsigned long long seen = 0;
+	for (int i = 0; i < bucketCount; i++)
+	{
+		seen += counts[i];
+		if (seen >= needed && seen > 0)
+		{
+			return i == bucketCount - 1 ? slowest : (i + 1) * latencyBucketMs;
+		}
+	}
+	return 0.0;
+}
+
+void LatencyHistogram::print(ostream& out) const
+{
+	out << "p50 " << percentile(0.5) << " ms, p95 " << percentile(0.95) << " ms, p99 " << percentile(0.99) << " ms, max " << slowest << " ms |";
+	for (int i = 0; i < bucketCount; i++)
+	{
+		if (counts[i] == 0)
+		{
+			continue;
+		}
+		if (i == bucketCount - 1)
+		{
+			out << " " << i * latencyBucketMs << "+: " << counts[i];
+		}
+		else
+		{
+			out << " " << i * latencyBucketMs << "-" << (i + 1) * latencyBucketMs << ": " << counts[i];
+		}
+	}
+}
+
+int AdaptiveVsync::update(double frameSeconds)
+{
+	// With vsync on a late frame waits for the following blank, so it shows up as one and a half budgets or more
+	if (interval == 1)
+	{
+		misses = frameSeconds > budget * 1.5 ? misses + 1 : 0;
+		if (misses >= missesToDisable)
+		{
+			interval = 0;
+			fits = 0;
+		}
+	}
+	else
+	{
+		fits = frameSeconds < budget * 0.85 ? fits + 1 : 0;
+		if (fits >= fitsToEnable)
+		{
+			interval = 1;
+			misses = 0;
+		}
+	}
+	return interval;
+}
+
+FramePacer::FramePacer(double targetHz, VsyncMode vsync)
+	: epoch(chrono::steady_clock::now()), target(targetHz), mode(vsync), adaptive(targetHz > 0.0 ? 1.0 / targetHz : 1.0 / 60.0)
+{
+	interval = vsync == VsyncOff ? 0 : 1;
+}
+
+void FramePacer::start(GLFWwindow* window)
+{
+	GLFWmonitor* monitor = glfwGetWindowMonitor(window);
+	const GLFWvidmode* videoMode = glfwGetVideoMode(monitor ? monitor : glfwGetPrimaryMonitor());
+	if (videoMode && videoMode->refreshRate > 0)
+	{
+		refresh = videoMode->refreshRate;
+	}
+
+	// Frames are due every refresh, or less often when the target rate is lower
+	adaptive = AdaptiveVsync(max(1.0 / refresh, target > 0.0 ? 1.0 / target : 0.0));
+
+	driverAdaptive = mode == VsyncAdaptive && (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"));
+	interval = driverAdaptive ? -1 : (mode == VsyncOff ? 0 : 1);
+	glfwSwapInterval(interval);
+	started = true;
+}
+
+double FramePacer::now() const
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - epoch).count();
+}
+
+void FramePacer::waitForFrame()
+{
+	if (target <= 0.0)
+	{
+		return;
+	}
+	double period = 1.0 / target;
+	double start = now();
+
+	// Sleep most of the way, then spin, since sleeps can overshoot by a scheduler tick
+	if (nextFrame - start > sleepMargin)
+	{
+		double sleepSeconds = nextFrame - start - sleepMargin;
+		this_thread::sleep_for(chrono::duration<double>(sleepSeconds));
+		double overslept = now() - start - sleepSeconds;
+		sleepMargin = max(0.001, max(sleepMargin * 0.99, min(overslept * 1.25, period * 0.5)));
+	}
+	while (now() < nextFrame)
+	{
+	}
+	double slot = now();
+	sleepMs += (slot - start) * 1000.0;
+
+	// Frames stay on the grid; a frame more than a period late starts a new one instead of bursting to catch up
+	nextFrame = slot - nextFrame > period ? slot + period : nextFrame + period;
+}
+
+void FramePacer::frameSkipped()
+{
+	lastPresent = -1.0;
+}
+
+void FramePacer::presented(double inputTime)
+{
+	double time = now();
+	if (inputTime >= 0.0)
+	{
+		latencies.add((time - inputTime) * 1000.0);
+	}
+
+	// Software adaptive vsync when the driver cannot do it
+	if (mode == VsyncAdaptive && !driverAdaptive && lastPresent >= 0.0)
+	{
+		int wanted = adaptive.update(time - lastPresent);
+		if (started && wanted != interval)
+		{
+			glfwSwapInterval(wanted);
+		}
+		interval = wanted;
+	}
+	lastPresent = time;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <chrono>
+#include <ostream>
+#include <GLFW/glfw3.h>     // GLFW library
+
+// How buffer swaps wait for the display
+enum VsyncMode
+{
+	VsyncOff,			// Present as soon as the frame is done; may tear
+	VsyncOn,			// Wait for the vertical blank every frame
+	VsyncAdaptive		// Wait for the blank while frames fit the refresh period; tear rather than drop to half rate
+};
+
+const char* vsyncModeName(VsyncMode mode);
+bool parseVsyncMode(const char* text, VsyncMode& mode);		// "off", "on" or "adaptive"
+
+// Width of one latency histogram bucket, in milliseconds
+const double latencyBucketMs = 2.0;
+
+// Input-to-present latencies of one reporting period in 2 ms buckets; the last bucket holds everything slower
+class LatencyHistogram
+{
+public:
+	static const int bucketCount = 25;
+
+	void add(double ms);
+	void clear();
+	unsigned long long count() const { return samples; }
+	unsigned long long bucket(int index) const { return counts[index]; }
+	double percentile(double fraction) const;	// Upper edge of the bucket reaching 'fraction' of the samples (the maximum in the last bucket); 0 when empty
+	double meanMs() const { return samples ? totalMs / samples : 0.0; }
+	double maxMs() const { return slowest; }
+	void print(std::ostream& out) const;		// Percentiles, then every non-empty bucket
+
+private:
+	unsigned long long counts[bucketCount] = {};
+	unsigned long long samples = 0;
+	double totalMs = 0.0;
+	double slowest = 0.0;
+};
+
+// Adaptive vsync for drivers without swap tear control. Vsync stays on while frames arrive within the frame
+// budget and goes off after a few frames miss it, so a slow stretch tears instead of halving the rate; it comes
+// back on once frames fit comfortably again.
+class AdaptiveVsync
+{
+public:
+	explicit AdaptiveVsync(double budgetSeconds) : budget(budgetSeconds) {}
+
+	int update(double frameSeconds);		// Swap interval to use after a frame that took 'frameSeconds' from present to present
+	int swapInterval() const { return interval; }
+
+	static const int missesToDisable = 3;	// Consecutive late frames before vsync goes off
+	static const int fitsToEnable = 60;		// Consecutive fast frames before it comes back on
+
+private:
+	double budget;
+	int interval = 1;
+	int misses = 0;
+	int fits = 0;
+};
+
+// Paces the render loop: sleeps each frame until its slot at the target rate, controls the swap interval and
+// measures the time from sampling a frame's input to presenting it. Call waitForFrame() before polling input,
+// presented() after glfwSwapBuffers(), and frameSkipped() for frames that present nothing.
+class FramePacer
+{
+public:
+	FramePacer(double targetHz, VsyncMode vsync);	// targetHz 0 leaves the rate to vsync or the hardware
+
+	// Read the display refresh rate and set the swap interval; needs the window's context to be current
+	void start(GLFWwindow* window);
+
+	double now() const;						// Seconds on the pacing clock
+	void waitForFrame();					// Returns at the start of this frame's slot
+	void frameSkipped();					// Nothing was presented; the next frame starts a fresh interval
+	void presented(double inputTime);		// Swap returned; latency is measured from 'inputTime' unless it is negative
+
+	const LatencyHistogram& latency() const { return latencies; }
+	void clearStats() { latencies.clear(); sleepMs = 0.0; }	// Start a new reporting period
+	double targetRate() const { return target; }
+	double refreshRate() const { return refresh; }
+	VsyncMode vsyncMode() const { return mode; }
+	bool tearControl() const { return driverAdaptive; }	// The driver does adaptive vsync itself (swap interval -1)
+	int swapInterval() const { return interval; }
+	double sleptMs() const { return sleepMs; }			// Time spent waiting for frame slots this reporting period
+
+private:
+	std::chrono::steady_clock::time_point epoch;
+	double target;
+	double refresh = 60.0;
+	VsyncMode mode;
+	bool driverAdaptive = false;
+	bool started = false;
+	int interval = 0;
+	AdaptiveVsync adaptive;
+	double nextFrame = 0.0;				// Start of the next frame's slot
+	double sleepMargin = 0.001;			// Woken this long before the slot and spun the rest; grows with observed oversleep
+	double lastPresent = -1.0;
+	double sleepMs = 0.0;
+	LatencyHistogram latencies;
+};
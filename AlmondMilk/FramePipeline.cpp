@@ -0,0 +1,57 @@
+#include "FramePipeline.h"
+#include "Profiler.h"
+
+#include <chrono>
+
+using namespace std;
+
+void FramePipeline::startBuild(Scene& scene, const ScenePool& pool, const glm::mat4& view, const glm::mat4& projection)
+{
+	DrawList& list = lists[building];
+	list.view = view;
+	list.projection = projection;
+	inFlight = true;
+	jobs.run(counter, [this, &scene, &pool, &list]()
+	{
+		PROFILE_SCOPE("Build draw list");
+		auto start = chrono::high_resolution_clock::now();
+		scene.cull(pool, list.projection * list.view, &jobs);
+		scene.buildInstances(pool, list, &jobs);
+		lastBuildMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	});
+}
+
+void FramePipeline::finishBuild()
+{
+	if (!inFlight)
+	{
+		return;
+	}
+	PROFILE_SCOPE("Wait for draw list");
+	auto start = chrono::high_resolution_clock::now();
+	jobs.wait(counter);
+	frameWaitMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	inFlight = false;
+}
+
+const DrawList* FramePipeline::listToSubmit()
+{
+	if (pipelining)
+	{
+		return previousReady ? &lists[building ^ 1] : nullptr;
+	}
+	finishBuild();
+	return &lists[building];
+}
+
+void FramePipeline::endFrame()
+{
+	finishBuild();
+	lastWaitMs = frameWaitMs;
+	frameWaitMs = 0.0;
+	if (pipelining)
+	{
+		previousReady = true;
+		building ^= 1;
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "JobSystem.h"
+#include "Scene.h"
+#include "ScenePool.h"
+
+// Splits a frame into a producer stage, where the job system culls the scene and builds a draw list, and a
+// consumer stage, where the GL thread submits a finished list. When pipelined, frame N + 1's list is built
+// while the GL thread submits frame N, at the cost of one frame of latency.
+class FramePipeline
+{
+public:
+	FramePipeline(JobSystem& jobs, bool pipelined) : jobs(jobs), pipelining(pipelined) {}
+
+	// Start building a frame's draw list on the job system. The scene must not change until endFrame().
+	void startBuild(Scene& scene, const ScenePool& pool, const glm::mat4& view, const glm::mat4& projection);
+
+	// List for the GL thread to submit now: when pipelined the one built during the previous frame (none on
+	// the first frame), otherwise the one just started, once it is finished
+	const DrawList* listToSubmit();
+
+	// Wait for this frame's build, helping with its jobs; afterwards the scene may change again
+	void endFrame();
+
+	bool pipelined() const { return pipelining; }
+	double buildMs() const { return lastBuildMs; }		// Duration of the last finished build
+	double waitMs() const { return lastWaitMs; }		// Time the GL thread spent waiting for builds last frame
+
+private:
+	void finishBuild();
+
+	JobSystem& jobs;
+	bool pipelining;
+	DrawList lists[2];
+	int building = 0;						// List written by the build in flight
+	bool previousReady = false;				// lists[building ^ 1] holds last frame's list
+	bool inFlight = false;
+	JobCounter counter;
+	double lastBuildMs = 0.0;
+	double lastWaitMs = 0.0, frameWaitMs = 0.0;
+};
@@ -0,0 +1,95 @@
+#include "Headless.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+GLFWwindow* createOffscreenContext(int width, int height)
+{
+	bool osmesa = getenv("ALMOND_OSMESA") != NULL;
+#ifdef GLFW_PLATFORM_NULL
+	if (osmesa)
+	{
+		glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);	// OSMesa renders to memory; no X11/Wayland/Win32 window needed
+	}
+#endif
+
+	// Initialize glfw library 
+	if (!glfwInit())
+	{
+		cout << "Offscreen: could not initialize GLFW" << endl;
+		return NULL;
+	}
+
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	if (osmesa)
+	{
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+	}
+	else if (getenv("ALMOND_EGL"))
+	{
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+	}
+
+	GLFWwindow* window = glfwCreateWindow(width, height, "AlmondMilk offscreen", NULL, NULL);
+	if (!window)
+	{
+		cout << "Offscreen: could not create context" << endl;
+		glfwTerminate();
+		return NULL;
+	}
+	glfwMakeContextCurrent(window);
+
+	// Initialize GLEW
+	if (glewInit() != GLEW_OK)
+	{
+		cout << "Error!" << endl;
+	}
+	return window;
+}
+
+bool Framebuffer::create(int width, int height, bool floatDepth)
+{
+	colorWidth = width;
+	colorHeight = height;
+	depthFloat = floatDepth;
+
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, floatDepth ? GL_DEPTH_COMPONENT32F : GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		cout << "Offscreen: framebuffer incomplete (0x" << hex << status << dec << ")" << endl;
+		destroy();
+		return false;
+	}
+	return true;
+}
+
+void Framebuffer::bind() const
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, colorWidth, colorHeight);
+}
+
+void Framebuffer::destroy()
+{
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	framebuffer = colorBuffer = depthBuffer = 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <GL/glew.h>        // GLEW library
+#include <GLFW/glfw3.h>     // GLFW library
+
+// Initialize GLFW and GLEW on a context that is never shown, for benchmarks and CI machines without a display.
+// ALMOND_OSMESA=1 selects a software OSMesa (llvmpipe) context; with GLFW 3.4 it also uses the null platform
+// so no display server is needed. ALMOND_EGL=1 selects an EGL context instead of the native one.
+// Returns NULL (after glfwTerminate) on failure; otherwise call glfwDestroyWindow and glfwTerminate when done.
+GLFWwindow* createOffscreenContext(int width, int height);
+
+// Color and depth render target so frames can be drawn without a default framebuffer
+class Framebuffer
+{
+public:
+	// 24-bit depth, or 32-bit float depth for reverse-Z. Returns false if the framebuffer is incomplete.
+	bool create(int width, int height, bool floatDepth = false);
+	void bind() const;
+	void destroy();
+
+	int width() const { return colorWidth; }
+	int height() const { return colorHeight; }
+	bool floatDepth() const { return depthFloat; }
+	GLuint handle() const { return framebuffer; }
+
+private:
+	GLuint framebuffer = 0;
+	GLuint colorBuffer = 0;
+	GLuint depthBuffer = 0;
+	int colorWidth = 0;
+	int colorHeight = 0;
+	bool depthFloat = false;
+};
@@ -0,0 +1,154 @@
+#include "InputRecording.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+static const char recordingMagic[4] = { 'A', 'M', 'I', 'R' };
+static const unsigned int recordingVersion = 1;
+static const std::streamoff tickCountOffset = 12;		// After magic, version and tick rate
+
+// Fixed-size fields written one by one so the file layout does not depend on struct padding
+template <class T>
+static void writeValue(ostream& out, const T& value)
+{
+	out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+static bool readValue(istream& in, T& value)
+{
+	return (bool)in.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+static void writeVec3(ostream& out, const glm::vec3& v)
+{
+	writeValue(out, v.x);
+	writeValue(out, v.y);
+	writeValue(out, v.z);
+}
+
+static bool readVec3(istream& in, glm::vec3& v)
+{
+	return readValue(in, v.x) && readValue(in, v.y) && readValue(in, v.z);
+}
+
+bool InputRecorder::open(const string& path)
+{
+	file.open(path, ios::binary | ios::trunc);
+	if (!file)
+	{
+		cout << "Failed to create input recording " << path << endl;
+		return false;
+	}
+
+	file.write(recordingMagic, 4);
+	writeValue(file, recordingVersion);
+	writeValue(file, (unsigned int)(1.0 / simulationStep + 0.5));
+	writeValue(file, 0u);					// Tick count, filled in by close()
+	writeVec3(file, cameraPosition);
+	writeVec3(file, cameraFront);
+	writeValue(file, yaw);
+	writeValue(file, pitch);
+	writeValue(file, cameraMovement);
+
+	heldKeys = 0;
+	tickCount = 0;
+	records = 0;
+	return true;
+}
+
+void InputRecorder::record(long long tick, const CameraInput& input)
+{
+	tickCount = (unsigned int)tick + 1;
+
+	// Held keys only need a record when they change; cursor and scroll are deltas and always do
+	if (input.keys == heldKeys && input.xTurn == 0.0f && input.yTurn == 0.0f && input.scroll == 0.0f)
+	{
+		return;
+	}
+	writeValue(file, (unsigned int)tick);
+	writeValue(file, input.keys);
+	writeValue(file, input.xTurn);
+	writeValue(file, input.yTurn);
+	writeValue(file, input.scroll);
+	heldKeys = input.keys;
+	records++;
+}
+
+void InputRecorder::close()
+{
+	if (!file.is_open())
+	{
+		return;
+	}
+	file.seekp(tickCountOffset);
+	writeValue(file, tickCount);
+	file.close();
+}
+
+bool InputReplay::load(const string& path)
+{
+	ifstream file(path, ios::binary);
+	if (!file)
+	{
+		cout << "Failed to open input recording " << path << endl;
+		return false;
+	}
+
+	char magic[4];
+	unsigned int version = 0, tickRate = 0, tickTotal = 0;
+	if (!file.read(magic, 4) || memcmp(magic, recordingMagic, 4) != 0 || !readValue(file, version) || version != recordingVersion)
+	{
+		cout << path << " is not an input recording" << endl;
+		return false;
+	}
+	if (!readValue(file, tickRate) || !readValue(file, tickTotal) || !readVec3(file, startPosition) || !readVec3(file, startFront)
+		|| !readValue(file, startYaw) || !readValue(file, startPitch) || !readValue(file, startMovement))
+	{
+		cout << "Input recording " << path << " is truncated" << endl;
+		return false;
+	}
+	if (tickRate != (unsigned int)(1.0 / simulationStep + 0.5))
+	{
+		cout << "Input recording " << path << " was made at " << tickRate << " ticks per second" << endl;
+		return false;
+	}
+
+	events.clear();
+	InputRecord record;
+	while (readValue(file, record.tick) && readValue(file, record.keys) && readValue(file, record.xTurn)
+		&& readValue(file, record.yTurn) && readValue(file, record.scroll))
+	{
+		events.push_back(record);
+	}
+	ticks = tickTotal;
+	rewind();
+	return true;
+}
+
+void InputReplay::restoreCamera() const
+{
+	initCamera();
+	cameraPosition = startPosition;
+	cameraFront = startFront;
+	yaw = startYaw;
+	pitch = startPitch;
+	cameraMovement = startMovement;
+}
+
+CameraInput InputReplay::inputForTick(long long tick)
+{
+	CameraInput input;
+	if (cursor < events.size() && events[cursor].tick == tick)
+	{
+		const InputRecord& record = events[cursor++];
+		heldKeys = record.keys;
+		input.xTurn = record.xTurn;
+		input.yTurn = record.yTurn;
+		input.scroll = record.scroll;
+	}
+	input.keys = heldKeys;
+	return input;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Camera.h"
+
+// Binary input recording: a header with the starting camera, then one record for every simulation tick
+// whose input changed the held keys or carried cursor or scroll movement. Ticks are the timestamps,
+// so a replay feeds stepCamera() exactly what the live session did.
+struct InputRecord
+{
+	unsigned int tick;
+	unsigned int keys;
+	GLfloat xTurn, yTurn, scroll;
+};
+
+// Writes ticks of camera input while the interactive scene runs
+class InputRecorder
+{
+public:
+	~InputRecorder() { close(); }
+
+	bool open(const std::string& path);		// Also stores the current camera as the starting state
+	void record(long long tick, const CameraInput& input);
+	void close();							// Writes the final tick count into the header
+	bool isOpen() const { return file.is_open(); }
+	size_t recordCount() const { return records; }
+
+private:
+	std::ofstream file;
+	unsigned int heldKeys = 0;
+	unsigned int tickCount = 0;
+	size_t records = 0;
+};
+
+// Reads a recording back and hands out the input for each tick in order
+class InputReplay
+{
+public:
+	bool load(const std::string& path);
+	void restoreCamera() const;				// Put the camera back in the recorded starting state
+	CameraInput inputForTick(long long tick);	// Ticks must be requested in increasing order
+	void rewind() { cursor = 0; heldKeys = 0; }
+	long long tickCount() const { return ticks; }
+	size_t recordCount() const { return events.size(); }
+
+private:
+	std::vector<InputRecord> events;
+	size_t cursor = 0;
+	unsigned int heldKeys = 0;
+	long long ticks = 0;
+	glm::vec3 startPosition, startFront;
+	GLfloat startYaw = 0.0f, startPitch = 0.0f, startMovement = 0.0f;
+};
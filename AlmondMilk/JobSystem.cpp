@@ -0,0 +1,145 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// Pool and queue the calling thread belongs to; threads outside any pool use queue 0
+static thread_local const JobSystem* currentPool = nullptr;
+static thread_local unsigned int currentQueue = 0;
+
+JobSystem::JobSystem(unsigned int threads) : queued(0), stealCount(0)
+{
+	if (threads == 0)
+	{
+		threads = max(thread::hardware_concurrency(), 1u);
+	}
+	for (unsigned int i = 0; i < threads; i++)
+	{
+		queues.emplace_back(new Queue());
+	}
+	for (unsigned int i = 1; i < threads; i++)
+	{
+		workers.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		lock_guard<mutex> lock(sleepLock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+unsigned int JobSystem::queueIndex() const
+{
+	return currentPool == this ? currentQueue : 0;
+}
+
+void JobSystem::push(const Job& job)
+{
+	job.counter->pending.fetch_add(1, memory_order_relaxed);
+	Queue& queue = *queues[queueIndex()];
+	{
+		lock_guard<mutex> lock(queue.lock);
+		size_t mask = queue.ring.size() - 1;
+		if (queue.tail - queue.head == queue.ring.size())
+		{
+			// Full: unwrap into a ring twice the size
+			vector<Job> grown(queue.ring.size() * 2);
+			for (size_t i = queue.head; i != queue.tail; i++)
+			{
+				grown[i - queue.head] = queue.ring[i & mask];
+			}
+			queue.tail -= queue.head;
+			queue.head = 0;
+			queue.ring.swap(grown);
+			mask = queue.ring.size() - 1;
+		}
+		queue.ring[queue.tail++ & mask] = job;
+	}
+	{
+		// Counted under the sleep lock so a worker about to sleep cannot miss it
+		lock_guard<mutex> lock(sleepLock);
+		queued.fetch_add(1, memory_order_relaxed);
+	}
+	wake.notify_one();
+}
+
+bool JobSystem::pop(unsigned int self, Job& job)
+{
+	{
+		Queue& own = *queues[self];
+		lock_guard<mutex> lock(own.lock);
+		if (own.head != own.tail)
+		{
+			job = own.ring[--own.tail & (own.ring.size() - 1)];
+			queued.fetch_sub(1, memory_order_relaxed);
+			return true;
+		}
+	}
+	for (unsigned int offset = 1; offset < queues.size(); offset++)
+	{
+		Queue& victim = *queues[(self + offset) % queues.size()];
+		lock_guard<mutex> lock(victim.lock);
+		if (victim.head != victim.tail)
+		{
+			job = victim.ring[victim.head++ & (victim.ring.size() - 1)];
+			queued.fetch_sub(1, memory_order_relaxed);
+			stealCount.fetch_add(1, memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::execute(Job& job)
+{
+	job.invoke(job.closure);
+	job.counter->pending.fetch_sub(1, memory_order_release);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	unsigned int self = queueIndex();
+	while (counter.pending.load(memory_order_acquire) > 0)
+	{
+		Job job;
+		if (pop(self, job))
+		{
+			execute(job);
+		}
+		else
+		{
+			// Remaining jobs are running on other threads
+			this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::workerLoop(unsigned int index)
+{
+	currentPool = this;
+	currentQueue = index;
+	for (;;)
+	{
+		Job job;
+		if (pop(index, job))
+		{
+			execute(job);
+			continue;
+		}
+		unique_lock<mutex> lock(sleepLock);
+		wake.wait(lock, [this]() { return stopping || queued.load(memory_order_relaxed) > 0; });
+		if (stopping)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Counts jobs that have not finished yet; wait() on it until it drops to zero
+struct JobCounter
+{
+	std::atomic<int> pending;
+
+	JobCounter() : pending(0) {}
+};
+
+// Work-stealing thread pool. Every thread owns a queue: it pushes and pops its own jobs at the back, and when
+// it runs dry it steals the oldest job from the front of another thread's queue. The thread that created the
+// pool owns queue 0 and runs jobs while it waits, so a pool of 1 thread runs everything on the caller.
+// Jobs are small closures copied into the queue, so queueing one does not touch the heap once the queues
+// have grown to the most jobs ever queued at once.
+class JobSystem
+{
+public:
+	explicit JobSystem(unsigned int threads = 0);		// Threads including the caller; one per core when 0
+	~JobSystem();
+
+	// Queue a job on the calling thread's queue; the counter is decremented when it finishes. The job is
+	// copied byte for byte, so it may only capture references, pointers and plain values.
+	template <typename Function>
+	void run(JobCounter& counter, const Function& job)
+	{
+		static_assert(sizeof(Function) <= sizeof(Job::closure) && alignof(Function) <= alignof(void*), "Job captures too much; capture a reference to the data instead");
+		static_assert(std::is_trivially_copyable<Function>::value && std::is_trivially_destructible<Function>::value, "Job captures must be trivially copyable");
+		Job queued;
+		new (queued.closure) Function(job);
+		queued.invoke = [](const void* closure) { (*(const Function*)closure)(); };
+		queued.counter = &counter;
+		push(queued);
+	}
+
+	// Run queued jobs, own or stolen, until the counter reaches zero
+	void wait(JobCounter& counter);
+
+	// Call body(first, last) for consecutive ranges of at most 'grain' indices in [0, count) and wait for all of them
+	template <typename Body>
+	void parallelFor(size_t count, size_t grain, const Body& body)
+	{
+		JobCounter counter;
+		for (size_t first = 0; first < count; first += grain)
+		{
+			size_t last = std::min(first + grain, count);
+			run(counter, [&body, first, last]() { body(first, last); });
+		}
+		wait(counter);
+	}
+
+	unsigned int threadCount() const { return (unsigned int)queues.size(); }
+	size_t steals() const { return stealCount.load(std::memory_order_relaxed); }
+
+private:
+	struct Job
+	{
+		void (*invoke)(const void* closure);
+		void* closure[6];						// The job's lambda, copied in place
+		JobCounter* counter;
+	};
+
+	// Ring of jobs, oldest at head; doubles when full and never shrinks
+	struct Queue
+	{
+		std::mutex lock;
+		std::vector<Job> ring;					// Power of two size
+		size_t head = 0, tail = 0;				// Oldest job and one past the newest, wrapped with the ring size
+
+		Queue() : ring(256) {}
+	};
+
+	void push(const Job& job);
+	unsigned int queueIndex() const;			// Queue of the calling thread
+	bool pop(unsigned int self, Job& job);		// Own newest job, else the oldest job of another queue
+	void execute(Job& job);
+	void workerLoop(unsigned int index);
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> workers;
+	std::mutex sleepLock;
+	std::condition_variable wake;
+	std::atomic<int> queued;					// Jobs sitting in any queue
+	std::atomic<size_t> stealCount;
+	bool stopping = false;						// Guarded by sleepLock
+};
@@ -0,0 +1,222 @@
+#include "MeshBuilder.h"
+#include "Primitives.h"
+
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <unordered_map>
+
+using namespace std;
+
+// Key for one interleaved vertex; compared bit for bit so only exact duplicates are welded
+struct VertexKey
+{
+	GLuint bits[floatsPerVertex];
+
+	bool operator==(const VertexKey& other) const
+	{
+		return memcmp(bits, other.bits, sizeof(bits)) == 0;
+	}
+};
+
+struct VertexKeyHash
+{
+	size_t operator()(const VertexKey& key) const
+	{
+		size_t hash = 2166136261u;		// FNV-1a over the float bit patterns
+		for (int i = 0; i < floatsPerVertex; i++)
+		{
+			hash = (hash ^ key.bits[i]) * 16777619u;
+		}
+		return hash;
+	}
+};
+
+IndexedMesh weldVertices(const GLfloat* vertices, GLsizei vertexCount)
+{
+	IndexedMesh mesh;
+	unordered_map<VertexKey, GLuint, VertexKeyHash> unique;
+	unique.reserve(vertexCount);
+	mesh.indices.reserve(vertexCount);
+	mesh.sourceVertexCount = vertexCount;
+
+	for (GLsizei v = 0; v < vertexCount; v++)
+	{
+		const GLfloat* vertex = vertices + v * floatsPerVertex;
+		VertexKey key;
+		memcpy(key.bits, vertex, sizeof(key.bits));
+
+		// Reuse index of earlier identical vertex, otherwise append a new one
+		auto found = unique.find(key);
+		if (found == unique.end())
+		{
+			GLuint index = (GLuint)unique.size();
+			unique.emplace(key, index);
+			mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + floatsPerVertex);
+			mesh.indices.push_back(index);
+		}
+		else
+		{
+			mesh.indices.push_back(found->second);
+		}
+	}
+	return mesh;
+}
+
+void optimizeVertexCache(vector<GLuint>& indices, GLsizei vertexCount, int cacheSize)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// Build vertex -> triangle adjacency
+	vector<int> liveTriangles(vertexCount, 0);
+	for (GLuint index : indices)
+	{
+		liveTriangles[index]++;
+	}
+	vector<int> adjacencyOffset(vertexCount + 1, 0);
+	for (GLsizei v = 0; v < vertexCount; v++)
+	{
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + liveTriangles[v];
+	}
+	vector<int> adjacency(indices.size());
+	vector<int> adjacencyFill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			adjacency[adjacencyFill[indices[t * 3 + corner]]++] = (int)t;
+		}
+	}
+
+	vector<int> cacheTime(vertexCount, 0);		// Time stamp of when each vertex entered the cache
+	vector<bool> emitted(triangleCount, false);
+	vector<int> deadEnd;						// Recently used vertices to resume from
+	vector<int> candidates;
+	vector<GLuint> output;
+	output.reserve(indices.size());
+
+	int fanning = 0;				// Vertex whose triangles are being emitted
+	int time = cacheSize + 1;
+	int cursor = 1;					// Next vertex to try when the dead-end stack runs dry
+
+	while (fanning >= 0)
+	{
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex
+		for (int a = adjacencyOffset[fanning]; a < adjacencyOffset[fanning + 1]; a++)
+		{
+			int t = adjacency[a];
+			if (emitted[t])
+			{
+				continue;
+			}
+			for (int corner = 0; corner < 3; corner++)
+			{
+				int v = indices[t * 3 + corner];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+				if (time - cacheTime[v] > cacheSize)
+				{
+					cacheTime[v] = time++;
+				}
+			}
+			emitted[t] = true;
+		}
+
+		// Pick next fanning vertex: the one still in cache that will stay there longest
+		int next = -1, bestPriority = -1;
+		for (int v : candidates)
+		{
+			if (liveTriangles[v] > 0)
+			{
+				int priority = 0;
+				if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+				{
+					priority = time - cacheTime[v];
+				}
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					next = v;
+				}
+			}
+		}
+
+		// Dead end: fall back to recently used vertices, then scan forward
+		while (next == -1 && !deadEnd.empty())
+		{
+			int v = deadEnd.back();
+			deadEnd.pop_back();
+			if (liveTriangles[v] > 0)
+			{
+				next = v;
+			}
+		}
+		while (next == -1 && cursor < vertexCount)
+		{
+			if (liveTriangles[cursor] > 0)
+			{
+				next = cursor;
+			}
+			cursor++;
+		}
+		fanning = next;
+	}
+
+	indices.swap(output);
+}
+
+float computeACMR(const vector<GLuint>& indices, GLsizei vertexCount, int cacheSize)
+{
+	if (indices.empty())
+	{
+		return 0.0f;
+	}
+
+	// Simulate FIFO post-transform cache
+	deque<GLuint> cache;
+	vector<bool> cached(vertexCount, false);
+	size_t misses = 0;
+	for (GLuint index : indices)
+	{
+		if (!cached[index])
+		{
+			misses++;
+			cache.push_back(index);
+			cached[index] = true;
+			if ((int)cache.size() > cacheSize)
+			{
+				cached[cache.front()] = false;
+				cache.pop_front();
+			}
+		}
+	}
+	return (float)misses / (float)(indices.size() / 3);
+}
+
+IndexedMesh buildIndexedMesh(const GLfloat* vertices, GLsizei vertexCount)
+{
+	IndexedMesh mesh = weldVertices(vertices, vertexCount);
+	mesh.acmrBefore = 3.0f;		// glDrawArrays shades every vertex of every triangle
+	mesh.acmrWelded = computeACMR(mesh.indices, mesh.vertexCount());
+	optimizeVertexCache(mesh.indices, mesh.vertexCount());
+	mesh.acmrAfter = computeACMR(mesh.indices, mesh.vertexCount());
+	return mesh;
+}
+
+void printMeshStats(const char* name, const IndexedMesh& mesh)
+{
+	size_t bytesBefore = mesh.sourceVertexCount * floatsPerVertex * sizeof(GLfloat);
+	size_t bytesAfter = mesh.vertices.size() * sizeof(GLfloat) + mesh.indices.size() * sizeof(GLuint);
+
+	cout << name << ": " << mesh.sourceVertexCount << " -> " << mesh.vertexCount() << " vertices, "
+		<< bytesBefore << " -> " << bytesAfter << " bytes, ACMR "
+		<< mesh.acmrBefore << " -> " << mesh.acmrWelded << " (welded) -> " << mesh.acmrAfter << " (optimized)" << endl;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <GL/glew.h>        // GLEW library
+
+#include "Primitives.h"
+
+// Post-transform vertex cache size assumed when optimizing and measuring meshes
+const int vertexCacheSize = 16;
+
+// Mesh with unique vertices and a triangle index buffer
+struct IndexedMesh
+{
+	std::vector<GLfloat> vertices;		// Interleaved x, y, z, r, g, b per unique vertex
+	std::vector<GLuint> indices;		// Three indices per triangle
+
+	// Statistics filled in by buildIndexedMesh
+	GLsizei sourceVertexCount = 0;		// Vertices in the original GL_TRIANGLES array
+	float acmrBefore = 0.0f;			// Average cache miss ratio of the original array (always 3.0)
+	float acmrWelded = 0.0f;			// ACMR after welding, in source triangle order
+	float acmrAfter = 0.0f;				// ACMR after vertex cache reordering
+
+	GLsizei vertexCount() const { return (GLsizei)(vertices.size() / floatsPerVertex); }
+	GLsizei indexCount() const { return (GLsizei)indices.size(); }
+};
+
+// Merge identical vertices of a GL_TRIANGLES array and emit the matching index buffer
+IndexedMesh weldVertices(const GLfloat* vertices, GLsizei vertexCount);
+
+// Reorder triangles for post-transform vertex cache locality (Tipsify, Sander et al. 2007)
+void optimizeVertexCache(std::vector<GLuint>& indices, GLsizei vertexCount, int cacheSize = vertexCacheSize);
+
+// Average cache miss ratio: vertex shader invocations per triangle with a FIFO cache of the given size
+float computeACMR(const std::vector<GLuint>& indices, GLsizei vertexCount, int cacheSize = vertexCacheSize);
+
+// Weld, reorder and measure a GL_TRIANGLES array in one step
+IndexedMesh buildIndexedMesh(const GLfloat* vertices, GLsizei vertexCount);
+
+// Print vertex counts, memory and ACMR savings of a built mesh
+void printMeshStats(const char* name, const IndexedMesh& mesh);
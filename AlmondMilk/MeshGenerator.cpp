@@ -0,0 +1,373 @@
+#include "MeshGenerator.h"
+#include "ScenePool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+static const float pi = 3.14159265358979f;
+static const glm::vec3 lightDirection = glm::normalize(glm::vec3(0.3f, 1.0f, 0.5f));
+
+ShapeDesc boxShape(const glm::vec3& size, const glm::vec3& color)
+{
+	ShapeDesc shape;
+	shape.type = BoxShape;
+	shape.size = size;
+	shape.segments = 1;
+	shape.color = color;
+	return shape;
+}
+
+ShapeDesc planeShape(float width, float depth, int subdivisions, const glm::vec3& color)
+{
+	ShapeDesc shape;
+	shape.type = PlaneShape;
+	shape.size = glm::vec3(width, 0.0f, depth);
+	shape.segments = subdivisions;
+	shape.color = color;
+	return shape;
+}
+
+ShapeDesc cylinderShape(float radius, float height, int segments, const glm::vec3& color)
+{
+	ShapeDesc shape;
+	shape.type = CylinderShape;
+	shape.radius = radius;
+	shape.height = height;
+	shape.segments = segments;
+	shape.color = color;
+	return shape;
+}
+
+ShapeDesc sphereShape(float radius, int segments, const glm::vec3& color)
+{
+	ShapeDesc shape;
+	shape.type = SphereShape;
+	shape.radius = radius;
+	shape.segments = segments;
+	shape.color = color;
+	return shape;
+}
+
+ShapeDesc torusShape(float radius, float tubeRadius, int segments, const glm::vec3& color)
+{
+	ShapeDesc shape;
+	shape.type = TorusShape;
+	shape.radius = radius;
+	shape.tubeRadius = tubeRadius;
+	shape.segments = segments;
+	shape.color = color;
+	return shape;
+}
+
+int shapeSegments(const ShapeDesc& shape, int lod)
+{
+	int minimum = 1;
+	switch (shape.type)
+	{
+	case BoxShape:		return 1;
+	case PlaneShape:	minimum = 1; break;
+	case CylinderShape:	minimum = 3; break;
+	case SphereShape:	minimum = 4; break;
+	case TorusShape:	minimum = 3; break;
+	}
+	int segments = shape.segments >> lod;
+	return max(segments, minimum);
+}
+
+float shapeRadius(const ShapeDesc& shape)
+{
+	switch (shape.type)
+	{
+	case BoxShape:		return glm::length(shape.size) * 0.5f;
+	case PlaneShape:	return glm::length(shape.size) * 0.5f;
+	case CylinderShape:	return sqrt(shape.radius * shape.radius + shape.height * shape.height * 0.25f);
+	case SphereShape:	return shape.radius;
+	case TorusShape:	return shape.radius + shape.tubeRadius;
+	}
+	return 0.0f;
+}
+
+// Append one vertex, shading the color by its normal
+static void addVertex(IndexedMesh& mesh, const glm::vec3& position, const glm::vec3& normal, const glm::vec3& color)
+{
+	float shade = 0.5f + 0.5f * max(glm::dot(normal, lightDirection), 0.0f);
+	GLfloat vertex[floatsPerVertex] = { position.x, position.y, position.z, color.x * shade, color.y * shade, color.z * shade };
+	mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + floatsPerVertex);
+}
+
+static void addTriangle(IndexedMesh& mesh, GLuint a, GLuint b, GLuint c)
+{
+	mesh.indices.push_back(a);
+	mesh.indices.push_back(b);
+	mesh.indices.push_back(c);
+}
+
+// Corners counter-clockwise when seen from the front
+static void addQuad(IndexedMesh& mesh, GLuint a, GLuint b, GLuint c, GLuint d)
+{
+	addTriangle(mesh, a, b, c);
+	addTriangle(mesh, a, c, d);
+}
+
+static void generateBox(IndexedMesh& mesh, const ShapeDesc& shape)
+{
+	// Corner i has x, y, z at the positive side when bit 0, 1, 2 is set
+	glm::vec3 half = shape.size * 0.5f;
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+		addVertex(mesh, corner * half, glm::normalize(corner), shape.color);
+	}
+	addQuad(mesh, 1, 3, 7, 5);		// +x
+	addQuad(mesh, 0, 4, 6, 2);		// -x
+	addQuad(mesh, 2, 6, 7, 3);		// +y
+	addQuad(mesh, 0, 1, 5, 4);		// -y
+	addQuad(mesh, 4, 5, 7, 6);		// +z
+	addQuad(mesh, 0, 2, 3, 1);		// -z
+}
+
+static void generatePlane(IndexedMesh& mesh, const ShapeDesc& shape, int n)
+{
+	// (n + 1) x (n + 1) grid in the xz plane facing +y
+	for (int i = 0; i <= n; i++)
+	{
+		for (int j = 0; j <= n; j++)
+		{
+			glm::vec3 position((i / (float)n - 0.5f) * shape.size.x, 0.0f, (j / (float)n - 0.5f) * shape.size.z);
+			addVertex(mesh, position, glm::vec3(0.0f, 1.0f, 0.0f), shape.color);
+		}
+	}
+	for (int i = 0; i < n; i++)
+	{
+		for (int j = 0; j < n; j++)
+		{
+			GLuint v = i * (n + 1) + j;
+			addQuad(mesh, v, v + 1, v + n + 2, v + n + 1);
+		}
+	}
+}
+
+static void generateCylinder(IndexedMesh& mesh, const ShapeDesc& shape, int n)
+{
+	// Bottom ring, top ring, then the two cap centers; the caps share the ring vertices
+	float halfHeight = shape.height * 0.5f;
+	for (int ring = 0; ring < 2; ring++)
+	{
+		for (int k = 0; k < n; k++)
+		{
+			float angle = 2.0f * pi * k / n;
+			glm::vec3 normal(cos(angle), 0.0f, sin(angle));
+			addVertex(mesh, normal * shape.radius + glm::vec3(0.0f, ring ? halfHeight : -halfHeight, 0.0f), normal, shape.color);
+		}
+	}
+	GLuint bottom = 2 * n, top = 2 * n + 1;
+	addVertex(mesh, glm::vec3(0.0f, -halfHeight, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), shape.color);
+	addVertex(mesh, glm::vec3(0.0f, halfHeight, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), shape.color);
+
+	for (int k = 0; k < n; k++)
+	{
+		GLuint next = (k + 1) % n;
+		addQuad(mesh, k, n + k, n + next, next);
+		addTriangle(mesh, bottom, k, next);
+		addTriangle(mesh, top, n + next, n + k);
+	}
+}
+
+static void generateSphere(IndexedMesh& mesh, const ShapeDesc& shape, int n)
+{
+	// n segments around y, n / 2 bands from pole to pole; rings exclude the two pole vertices
+	int bands = max(n / 2, 2);
+	for (int band = 1; band < bands; band++)
+	{
+		float polar = pi * band / bands;
+		for (int k = 0; k < n; k++)
+		{
+			float angle = 2.0f * pi * k / n;
+			glm::vec3 normal(sin(polar) * cos(angle), cos(polar), sin(polar) * sin(angle));
+			addVertex(mesh, normal * shape.radius, normal, shape.color);
+		}
+	}
+	GLuint north = (bands - 1) * n, south = north + 1;
+	addVertex(mesh, glm::vec3(0.0f, shape.radius, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), shape.color);
+	addVertex(mesh, glm::vec3(0.0f, -shape.radius, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), shape.color);
+
+	for (int k = 0; k < n; k++)
+	{
+		GLuint next = (k + 1) % n;
+		addTriangle(mesh, k, north, next);
+		for (int band = 1; band < bands - 1; band++)
+		{
+			GLuint upper = (band - 1) * n, lower = band * n;
+			addQuad(mesh, lower + k, upper + k, upper + next, lower + next);
+		}
+		GLuint last = (bands - 2) * n;
+		addTriangle(mesh, south, last + k, last + next);
+	}
+}
+
+static void generateTorus(IndexedMesh& mesh, const ShapeDesc& shape, int n)
+{
+	// n segments around the ring, n / 2 around the tube
+	int sides = max(n / 2, 3);
+	for (int k = 0; k < n; k++)
+	{
+		float angle = 2.0f * pi * k / n;
+		glm::vec3 outward(cos(angle), 0.0f, sin(angle));
+		for (int m = 0; m < sides; m++)
+		{
+			float tube = 2.0f * pi * m / sides;
+			glm::vec3 normal = outward * cos(tube) + glm::vec3(0.0f, sin(tube), 0.0f);
+			addVertex(mesh, outward * shape.radius + normal * shape.tubeRadius, normal, shape.color);
+		}
+	}
+	for (int k = 0; k < n; k++)
+	{
+		GLuint ring = k * sides, nextRing = ((k + 1) % n) * sides;
+		for (int m = 0; m < sides; m++)
+		{
+			GLuint next = (m + 1) % sides;
+			addQuad(mesh, ring + m, ring + next, nextRing + next, nextRing + m);
+		}
+	}
+}
+
+IndexedMesh generateShape(const ShapeDesc& shape, int lod)
+{
+	IndexedMesh mesh;
+	int segments = shapeSegments(shape, lod);
+	switch (shape.type)
+	{
+	case BoxShape:		generateBox(mesh, shape); break;
+	case PlaneShape:	generatePlane(mesh, shape, segments); break;
+	case CylinderShape:	generateCylinder(mesh, shape, segments); break;
+	case SphereShape:	generateSphere(mesh, shape, segments); break;
+	case TorusShape:	generateTorus(mesh, shape, segments); break;
+	}
+
+	// Same statistics buildIndexedMesh reports, measured against drawing the triangles unindexed
+	mesh.sourceVertexCount = mesh.indexCount();
+	mesh.acmrBefore = 3.0f;
+	mesh.acmrWelded = computeACMR(mesh.indices, mesh.vertexCount());
+	optimizeVertexCache(mesh.indices, mesh.vertexCount());
+	mesh.acmrAfter = computeACMR(mesh.indices, mesh.vertexCount());
+	return mesh;
+}
+
+vector<IndexedMesh> generateShapes(const vector<ShapeDesc>& shapes, const vector<int>& lods, unsigned int threads)
+{
+	vector<IndexedMesh> meshes(shapes.size());
+	if (threads == 0)
+	{
+		threads = max(thread::hardware_concurrency(), 1u);
+	}
+	threads = (unsigned int)min((size_t)threads, shapes.size());
+
+	// Workers take the next shape from a shared counter, so a few large shapes do not leave cores idle
+	atomic<size_t> next(0);
+	auto worker = [&]()
+	{
+		for (size_t i = next++; i < shapes.size(); i = next++)
+		{
+			meshes[i] = generateShape(shapes[i], lods[i]);
+		}
+	};
+	vector<thread> pool;
+	for (unsigned int t = 1; t < threads; t++)
+	{
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (thread& t : pool)
+	{
+		t.join();
+	}
+	return meshes;
+}
+
+size_t countOpenEdges(const IndexedMesh& mesh)
+{
+	// Each directed edge a->b must be matched by exactly one b->a
+	map<pair<GLuint, GLuint>, int> edges;
+	for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+	{
+		for (int e = 0; e < 3; e++)
+		{
+			GLuint a = mesh.indices[t + e], b = mesh.indices[t + (e + 1) % 3];
+			edges[make_pair(a, b)]++;
+		}
+	}
+	size_t open = 0;
+	for (const auto& edge : edges)
+	{
+		auto twin = edges.find(make_pair(edge.first.second, edge.first.first));
+		if (edge.second != 1 || twin == edges.end() || twin->second != 1)
+		{
+			open++;
+		}
+	}
+	return open;
+}
+
+vector<LodChain> addLodChains(ScenePool& pool, const vector<ShapeDesc>& shapes, int levels)
+{
+	// One job per distinct level of each shape
+	vector<ShapeDesc> jobShapes;
+	vector<int> jobLods;
+	for (const ShapeDesc& shape : shapes)
+	{
+		for (int lod = 0; lod < levels; lod++)
+		{
+			if (lod == 0 || shapeSegments(shape, lod) != shapeSegments(shape, lod - 1))
+			{
+				jobShapes.push_back(shape);
+				jobLods.push_back(lod);
+			}
+		}
+	}
+	vector<IndexedMesh> meshes = generateShapes(jobShapes, jobLods);
+
+	vector<LodChain> chains(shapes.size());
+	size_t job = 0;
+	for (size_t s = 0; s < shapes.size(); s++)
+	{
+		chains[s].radius = shapeRadius(shapes[s]);
+		for (int lod = 0; lod < levels; lod++)
+		{
+			if (lod == 0 || shapeSegments(shapes[s], lod) != shapeSegments(shapes[s], lod - 1))
+			{
+				chains[s].meshes.push_back(pool.addMesh(meshes[job++]));
+			}
+			else
+			{
+				chains[s].meshes.push_back(chains[s].meshes.back());
+			}
+		}
+	}
+	return chains;
+}
+
+float projectedSize(float radius, float distance, float fovDegrees)
+{
+	return radius / (distance * tan(glm::radians(fovDegrees) * 0.5f));
+}
+
+int selectLod(float radius, float distance, float fovDegrees, int levels)
+{
+	if (fovDegrees <= 0.0f || distance <= radius)
+	{
+		return 0;
+	}
+	float size = projectedSize(radius, distance, fovDegrees);
+	int lod = 0;
+	for (float threshold = lodFullDetailSize; lod < levels - 1 && size < threshold; threshold *= 0.5f)
+	{
+		lod++;
+	}
+	return lod;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+
+// GLM Libraries
+#include <glm/glm.hpp> 
+
+#include "MeshBuilder.h"
+
+class ScenePool;
+
+enum ShapeType { BoxShape, PlaneShape, CylinderShape, SphereShape, TorusShape };
+
+// Parametric shape centered on the origin; each type reads only its own fields
+struct ShapeDesc
+{
+	ShapeType type = BoxShape;
+	glm::vec3 size = glm::vec3(1.0f);	// Box extents; plane width (x) and depth (z)
+	float radius = 1.0f;				// Cylinder and sphere radius, torus ring radius
+	float height = 1.0f;				// Cylinder height along y
+	float tubeRadius = 0.25f;			// Torus tube radius
+	int segments = 32;					// Subdivisions around y (plane: per side) at full detail
+	glm::vec3 color = glm::vec3(1.0f);
+};
+
+ShapeDesc boxShape(const glm::vec3& size, const glm::vec3& color);
+ShapeDesc planeShape(float width, float depth, int subdivisions, const glm::vec3& color);
+ShapeDesc cylinderShape(float radius, float height, int segments, const glm::vec3& color);
+ShapeDesc sphereShape(float radius, int segments, const glm::vec3& color);
+ShapeDesc torusShape(float radius, float tubeRadius, int segments, const glm::vec3& color);
+
+// Subdivisions used at a level of detail: halved per level down to the shape's minimum
+int shapeSegments(const ShapeDesc& shape, int lod);
+float shapeRadius(const ShapeDesc& shape);		// Bounding sphere radius
+
+// Indexed, vertex cache ordered mesh with counter-clockwise outward faces. Vertex colors are the shape
+// color shaded by a fixed light direction, since the scene shader does no lighting of its own.
+IndexedMesh generateShape(const ShapeDesc& shape, int lod = 0);
+
+// Generate shapes[i] at lods[i] on 'threads' worker threads (all cores when 0); results in input order
+std::vector<IndexedMesh> generateShapes(const std::vector<ShapeDesc>& shapes, const std::vector<int>& lods, unsigned int threads = 0);
+
+// Triangle edges not shared by exactly one other triangle in the opposite direction; zero for a closed mesh
+size_t countOpenEdges(const IndexedMesh& mesh);
+
+// Pool meshes of one shape from finest to coarsest; levels whose tessellation stops changing share a mesh
+struct LodChain
+{
+	std::vector<int> meshes;
+	float radius = 0.0f;				// Model-space bounding sphere radius
+};
+
+// Generate every level of every shape in parallel, then add them to the pool in order
+std::vector<LodChain> addLodChains(ScenePool& pool, const std::vector<ShapeDesc>& shapes, int levels);
+
+// Projected size at which level 0 stops being used: the bounding sphere covers a quarter of the screen height.
+// Level i is used down to half the size of level i - 1, so triangles keep roughly the same size on screen.
+const float lodFullDetailSize = 0.25f;
+
+// Fraction of the screen height covered by a bounding sphere at 'distance' with a vertical field of view in degrees
+float projectedSize(float radius, float distance, float fovDegrees);
+
+// Level of detail for a bounding sphere; 0 when the camera is inside it or fovDegrees is 0 (orthographic)
+int selectLod(float radius, float distance, float fovDegrees, int levels);
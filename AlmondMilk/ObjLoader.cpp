@@ -0,0 +1,88 @@
+#include "ObjLoader.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+bool loadObjMesh(const string& path, IndexedMesh& mesh)
+{
+	ifstream file(path);
+	if (!file)
+	{
+		cout << "Failed to open OBJ file " << path << endl;
+		return false;
+	}
+
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	string line;
+	int lineNumber = 0;
+	GLuint polygon[64];
+	while (getline(file, line))
+	{
+		lineNumber++;
+		const char* c = line.c_str();
+		if (c[0] == 'v' && c[1] == ' ')
+		{
+			// Position, then optional vertex color
+			char* end;
+			GLfloat values[6] = { 0.0f, 0.0f, 0.0f, 0.8f, 0.8f, 0.8f };
+			c += 2;
+			for (int i = 0; i < 6; i++)
+			{
+				GLfloat value = strtof(c, &end);
+				if (end == c)
+				{
+					break;
+				}
+				values[i] = value;
+				c = end;
+			}
+			mesh.vertices.insert(mesh.vertices.end(), values, values + 6);
+		}
+		else if (c[0] == 'f' && c[1] == ' ')
+		{
+			// Each corner is v, v/vt, v//vn or v/vt/vn; only v is used
+			int corners = 0;
+			char* end;
+			c += 2;
+			while (corners < 64)
+			{
+				long index = strtol(c, &end, 10);
+				if (end == c)
+				{
+					break;
+				}
+				long vertexTotal = (long)mesh.vertices.size() / 6;
+				index = index < 0 ? vertexTotal + index : index - 1;		// Negative indices count back from the last vertex
+				if (index < 0 || index >= vertexTotal)
+				{
+					cout << path << ":" << lineNumber << ": face refers to missing vertex" << endl;
+					return false;
+				}
+				polygon[corners++] = (GLuint)index;
+				c = end;
+				while (*c && *c != ' ' && *c != '\t')
+				{
+					c++;
+				}
+			}
+			for (int i = 2; i < corners; i++)
+			{
+				mesh.indices.push_back(polygon[0]);
+				mesh.indices.push_back(polygon[i - 1]);
+				mesh.indices.push_back(polygon[i]);
+			}
+		}
+	}
+
+	mesh.sourceVertexCount = mesh.indexCount();
+	if (mesh.indices.empty())
+	{
+		cout << "OBJ file " << path << " has no faces" << endl;
+		return false;
+	}
+	return true;
+}
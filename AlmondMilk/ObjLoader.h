@@ -0,0 +1,9 @@
+#pragma once
+#include <string>
+
+#include "MeshBuilder.h"
+
+// Load the triangles of a Wavefront OBJ text file as an indexed mesh. Reads "v x y z [r g b]" and
+// "f" lines (polygons are fan-triangulated, texture and normal indices ignored); vertices without
+// a color are light grey. Returns false and prints the reason if the file cannot be read.
+bool loadObjMesh(const std::string& path, IndexedMesh& mesh);
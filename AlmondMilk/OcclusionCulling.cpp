@@ -0,0 +1,394 @@
+#include "OcclusionCulling.h"
+#include "Shaders.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+// Reduces 'source' at 'sourceLevel' into one level of the pyramid: every target texel keeps the farthest depth of
+// the source texels it overlaps. Level 0 reads the occluder depth texture, which need not be a power of two.
+static const string reduceShaderSource =
+	"#version 430 core\n"
+	"layout(local_size_x = 8, local_size_y = 8) in;"
+	"layout(binding = 0) uniform sampler2D source;"
+	"layout(r32f, binding = 0) writeonly uniform image2D target;"
+	"uniform int sourceLevel;"
+	"uniform bool reverseDepth;"				// Farthest is the smallest depth with reverse-Z
+	"void main()\n"
+	"{\n"
+	"ivec2 texel = ivec2(gl_GlobalInvocationID.xy);"
+	"ivec2 targetSize = imageSize(target);"
+	"if (any(greaterThanEqual(texel, targetSize))) return;"
+	"ivec2 sourceSize = textureSize(source, sourceLevel);"
+	"ivec2 first = texel * sourceSize / targetSize;"
+	"ivec2 last = min(((texel + 1) * sourceSize + targetSize - 1) / targetSize, sourceSize) - 1;"
+	"float farthest = reverseDepth ? 1.0 : 0.0;"
+	"for (int y = first.y; y <= last.y; y++)"
+	"for (int x = first.x; x <= last.x; x++)"
+	"{"
+	"float depth = texelFetch(source, ivec2(x, y), sourceLevel).r;"
+	"farthest = reverseDepth ? min(farthest, depth) : max(farthest, depth);"
+	"}"
+	"imageStore(target, texel, vec4(farthest));"
+	"}\n";
+
+// One invocation per instance. Projects the instance's bounding box, picks the pyramid level where its screen
+// rectangle spans at most 2x2 texels and compares its nearest depth with the farthest depth under them. Boxes
+// crossing the camera plane always pass. Passing instances take the next slot of their batch's command.
+static const string cullShaderSource =
+	"#version 430 core\n"
+	"layout(local_size_x = 64) in;"
+	"layout(std140) uniform Camera"				// Shared by every program; see CameraBlock
+	"{"
+	"mat4 view;"
+	"mat4 projection;"
+	"mat4 viewProjection;"
+	"};"
+	"struct CullBatch { vec4 boundsMin; vec4 boundsMax; uint firstInstance; uint instanceCount; uint tested; uint padding; };"
+	"struct DrawCommand { uint count; uint instanceCount; uint firstIndex; int baseVertex; uint baseInstance; };"
+	"layout(std430, binding = 0) readonly buffer Instances { mat4 instanceModel[]; };"
+	"layout(std430, binding = 1) readonly buffer Batches { CullBatch batches[]; };"
+	"layout(std430, binding = 2) buffer Commands { DrawCommand commands[]; };"
+	"layout(std430, binding = 3) writeonly buffer VisibleInstances { mat4 visibleModel[]; };"
+	"layout(std430, binding = 4) buffer Counters { uint occluded; };"
+	"layout(binding = 0) uniform sampler2D hiZ;"
+	"uniform uint instanceBase;"				// First matrix of this frame in Instances
+	"uniform uint instanceCount;"
+	"uniform uint batchCount;"
+	"uniform int levels;"
+	"uniform bool reverseDepth;"
+	"bool hidden(mat4 model, vec3 boundsMin, vec3 boundsMax)\n"
+	"{\n"
+	"mat4 toClip = viewProjection * model;"
+	"vec2 rectMin = vec2(1.0e30), rectMax = vec2(-1.0e30);"
+	"float nearest = reverseDepth ? -1.0e30 : 1.0e30;"
+	"for (int corner = 0; corner < 8; corner++)"
+	"{"
+	"vec4 clip = toClip * vec4(mix(boundsMin, boundsMax, vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1)), 1.0);"
+	"if (clip.w <= 0.0) return false;"
+	"vec3 ndc = clip.xyz / clip.w;"
+	"rectMin = min(rectMin, ndc.xy);"
+	"rectMax = max(rectMax, ndc.xy);"
+	"nearest = reverseDepth ? max(nearest, ndc.z) : min(nearest, ndc.z * 0.5 + 0.5);"
+	"}"
+	"ivec2 size = textureSize(hiZ, 0);"
+	"ivec2 texelMin = min(ivec2(clamp(rectMin * 0.5 + 0.5, 0.0, 1.0) * vec2(size)), size - 1);"
+	"ivec2 texelMax = min(ivec2(clamp(rectMax * 0.5 + 0.5, 0.0, 1.0) * vec2(size)), size - 1);"
+	"int level = 0;"
+	"while (level < levels - 1 && any(greaterThan((texelMax >> level) - (texelMin >> level), ivec2(1)))) level++;"
+	"ivec2 a = texelMin >> level, b = texelMax >> level;"
+	"vec4 farthest = vec4(texelFetch(hiZ, a, level).r, texelFetch(hiZ, ivec2(b.x, a.y), level).r, texelFetch(hiZ, ivec2(a.x, b.y), level).r, texelFetch(hiZ, b, level).r);"
+	"if (reverseDepth) return nearest < min(min(farthest.x, farthest.y), min(farthest.z, farthest.w));"
+	"return nearest > max(max(farthest.x, farthest.y), max(farthest.z, farthest.w));"
+	"}\n"
+	"void main()\n"
+	"{\n"
+	"uint instance = gl_GlobalInvocationID.x;"
+	"if (instance >= instanceCount) return;"
+	"uint low = 0u, high = batchCount - 1u;"	// Batches are in instance order
+	"while (low < high)"
+	"{"
+	"uint middle = (low + high + 1u) / 2u;"
+	"if (batches[middle].firstInstance <= instance) low = middle; else high = middle - 1u;"
+	"}"
+	"mat4 model = instanceModel[instanceBase + instance];"
+	"if (batches[low].tested == 0u)"
+	"{"
+	"visibleModel[instance] = model;"
+	"return;"
+	"}"
+	"if (hidden(model, batches[low].boundsMin.xyz, batches[low].boundsMax.xyz))"
+	"{"
+	"atomicAdd(occluded, 1u);"
+	"return;"
+	"}"
+	"uint slot = atomicAdd(commands[low].instanceCount, 1u);"
+	"visibleModel[batches[low].firstInstance + slot] = model;"
+	"}\n";
+
+// Largest power of two not above 'value'
+static int floorPowerOfTwo(int value)
+{
+	int power = 1;
+	while (power * 2 <= value)
+	{
+		power *= 2;
+	}
+	return power;
+}
+
+int markLargeOccluders(ScenePool& pool, float fraction)
+{
+	float largest = 0.0f;
+	for (int i = 0; i < pool.meshCount(); i++)
+	{
+		largest = max(largest, glm::length(pool.mesh(i).bounds.max - pool.mesh(i).bounds.min));
+	}
+	int marked = 0;
+	for (int i = 0; i < pool.meshCount(); i++)
+	{
+		bool large = glm::length(pool.mesh(i).bounds.max - pool.mesh(i).bounds.min) >= largest * fraction;
+		pool.setMeshOccluder(i, large);
+		marked += large;
+	}
+	return marked;
+}
+
+bool OcclusionCuller::supported()
+{
+	return GLEW_VERSION_4_3 != GL_FALSE;
+}
+
+bool OcclusionCuller::create()
+{
+	reduceProgram = CreateComputeProgram(reduceShaderSource);
+	cullProgram = CreateComputeProgram(cullShaderSource);
+	if (!reduceProgram || !cullProgram)
+	{
+		destroy();
+		return false;
+	}
+	reduceSourceLevel = glGetUniformLocation(reduceProgram, "sourceLevel");
+	reduceReverse = glGetUniformLocation(reduceProgram, "reverseDepth");
+	cullInstanceBase = glGetUniformLocation(cullProgram, "instanceBase");
+	cullInstanceCount = glGetUniformLocation(cullProgram, "instanceCount");
+	cullBatchCount = glGetUniformLocation(cullProgram, "batchCount");
+	cullLevels = glGetUniformLocation(cullProgram, "levels");
+	cullReverse = glGetUniformLocation(cullProgram, "reverseDepth");
+	BindCameraBlock(cullProgram);
+
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+	glGenBuffers(1, &batchBuffer);
+	glGenBuffers(1, &commandBuffer);
+	glGenBuffers(1, &visibleBuffer);
+	glGenBuffers(counterSlots, counterBuffers);
+	for (int i = 0; i < counterSlots; i++)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffers[i]);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_READ);
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	return true;
+}
+
+void OcclusionCuller::destroy()
+{
+	releaseTargets();
+	glDeleteProgram(reduceProgram);
+	glDeleteProgram(cullProgram);
+	glDeleteBuffers(1, &batchBuffer);
+	glDeleteBuffers(1, &commandBuffer);
+	glDeleteBuffers(1, &visibleBuffer);
+	glDeleteBuffers(counterSlots, counterBuffers);
+	reduceProgram = cullProgram = 0;
+	batchBuffer = commandBuffer = visibleBuffer = 0;
+	visibleCapacity = 0;
+	for (int i = 0; i < counterSlots; i++)
+	{
+		counterBuffers[i] = 0;
+		glDeleteSync(slotFences[i]);
+		slotFences[i] = 0;
+	}
+}
+
+void OcclusionCuller::releaseTargets()
+{
+	glDeleteFramebuffers(1, &depthFramebuffer);
+	glDeleteTextures(1, &depthTexture);
+	glDeleteTextures(1, &hiZTexture);
+	depthFramebuffer = depthTexture = hiZTexture = 0;
+	depthWidth = depthHeight = 0;
+	hiZWidth = hiZHeight = hiZLevels = 0;
+}
+
+// Recreate the occluder depth target and the pyramid when the viewport changes size
+void OcclusionCuller::resize(int width, int height)
+{
+	if (width == depthWidth && height == depthHeight)
+	{
+		return;
+	}
+	releaseTargets();
+	depthWidth = max(width, 1);
+	depthHeight = max(height, 1);
+
+	// Float depth serves both depth conventions
+	glGenTextures(1, &depthTexture);
+	glBindTexture(GL_TEXTURE_2D, depthTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, depthWidth, depthHeight);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glGenFramebuffers(1, &depthFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, depthFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	// Power-of-two levels halve exactly, so every level above 0 is a plain 2x2 reduction
+	hiZWidth = floorPowerOfTwo(depthWidth);
+	hiZHeight = floorPowerOfTwo(depthHeight);
+	hiZLevels = 1;
+	while ((max(hiZWidth, hiZHeight) >> (hiZLevels - 1)) > 1)
+	{
+		hiZLevels++;
+	}
+	glGenTextures(1, &hiZTexture);
+	glBindTexture(GL_TEXTURE_2D, hiZTexture);
+	glTexStorage2D(GL_TEXTURE_2D, hiZLevels, GL_R32F, hiZWidth, hiZHeight);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void OcclusionCuller::cull(ScenePool& pool, RenderState& state, const DrawBatch* batches, size_t batchCount, bool reverseDepth)
+{
+	GLuint drawProgram = state.program();
+	GLint framebuffer = 0;
+	GLint viewport[4];
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	resize(viewport[2], viewport[3]);
+
+	// Counters of this slot's last frame are three frames old by now; if the GPU is even further behind, that
+	// frame's numbers are dropped rather than waited for
+	slot = (slot + 1) % counterSlots;
+	if (slotFences[slot])
+	{
+		GLenum status = glClientWaitSync(slotFences[slot], 0, 0);
+		if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+		{
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffers[slot]);
+			glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &slotStats[slot].occluded);
+			lastStats = slotStats[slot];
+		}
+		glDeleteSync(slotFences[slot]);
+		slotFences[slot] = 0;
+	}
+
+	// Commands start with no instances; the shader counts the visible ones in
+	occluderBatches.clear();
+	cullBatches.resize(batchCount);
+	commands.resize(batchCount);
+	GLuint instanceCount = 0;
+	OcclusionStats& frame = slotStats[slot];
+	frame = OcclusionStats();
+	for (size_t i = 0; i < batchCount; i++)
+	{
+		const DrawBatch& batch = batches[i];
+		const MeshRange& range = pool.mesh(batch.mesh);
+		AABB bounds = pool.storedBounds(batch.mesh);
+		cullBatches[i].boundsMin = glm::vec4(bounds.min, 0.0f);
+		cullBatches[i].boundsMax = glm::vec4(bounds.max, 0.0f);
+		cullBatches[i].firstInstance = batch.firstInstance;
+		cullBatches[i].instanceCount = batch.instanceCount;
+		cullBatches[i].tested = keyPass(batch.key) == OpaquePass;
+		commands[i].count = range.indexCount;
+		commands[i].instanceCount = cullBatches[i].tested ? 0 : batch.instanceCount;
+		commands[i].firstIndex = range.firstIndex;
+		commands[i].baseVertex = range.baseVertex;
+		commands[i].baseInstance = batch.firstInstance;
+		instanceCount = max(instanceCount, batch.firstInstance + batch.instanceCount);
+		if (cullBatches[i].tested)
+		{
+			frame.tested += batch.instanceCount;
+		}
+		if (range.occluder && keyPass(batch.key) == OpaquePass)
+		{
+			occluderBatches.push_back(batch);
+			frame.occluderInstances += batch.instanceCount;
+		}
+	}
+
+	// Occluders, depth only, into the pyramid's source
+	glBindFramebuffer(GL_FRAMEBUFFER, depthFramebuffer);
+	glViewport(0, 0, depthWidth, depthHeight);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	if (!occluderBatches.empty())
+	{
+		pool.draw(state, occluderBatches.data(), occluderBatches.size());
+	}
+
+	// Farthest depth pyramid, one dispatch per level
+	state.useProgram(reduceProgram);
+	glUniform1i(reduceReverse, reverseDepth);
+	glActiveTexture(GL_TEXTURE0);
+	for (int level = 0; level < hiZLevels; level++)
+	{
+		glBindTexture(GL_TEXTURE_2D, level == 0 ? depthTexture : hiZTexture);
+		glUniform1i(reduceSourceLevel, level == 0 ? 0 : level - 1);
+		glBindImageTexture(0, hiZTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		int levelWidth = max(hiZWidth >> level, 1);
+		int levelHeight = max(hiZHeight >> level, 1);
+		glDispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+
+	// Orphan last frame's batches and commands; the draw of that frame may still read them
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, batchBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, batchCount * sizeof(CullBatch), cullBatches.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, batchCount * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_DRAW);
+	GLsizeiptr visibleBytes = instanceCount * sizeof(glm::mat4);
+	if (visibleBytes > visibleCapacity)
+	{
+		visibleCapacity = max(visibleBytes, visibleCapacity * 3 / 2);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, visibleCapacity, nullptr, GL_DYNAMIC_COPY);
+	}
+	// Fresh storage, so zeroing never waits for a dispatch still reading the old counter
+	GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffers[slot]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), &zero, GL_DYNAMIC_READ);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	if (instanceCount > 0)
+	{
+		// This frame's matrices in the stream buffer, bound from an offset the driver accepts
+		GLintptr first = (GLintptr)pool.instanceStreamBase() * sizeof(glm::mat4);
+		GLintptr rangeStart = first - first % storageAlignment;
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, pool.instanceStreamBuffer(), rangeStart, first + visibleBytes - rangeStart);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, batchBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, visibleBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, counterBuffers[slot]);
+
+		state.useProgram(cullProgram);
+		glUniform1ui(cullInstanceBase, (GLuint)((first - rangeStart) / sizeof(glm::mat4)));
+		glUniform1ui(cullInstanceCount, instanceCount);
+		glUniform1ui(cullBatchCount, (GLuint)batchCount);
+		glUniform1i(cullLevels, hiZLevels);
+		glUniform1i(cullReverse, reverseDepth);
+		glBindTexture(GL_TEXTURE_2D, hiZTexture);
+		glDispatchCompute((instanceCount + 63) / 64, 1, 1);
+
+		// The draws read the commands and matrices the shader wrote
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+		slotFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	state.useProgram(drawProgram);
+}
+
+void OcclusionCuller::draw(ScenePool& pool, RenderState& state, const DrawBatch* batches, size_t batchCount)
+{
+	pool.drawIndirect(state, batches, batchCount, commandBuffer, visibleBuffer);
+}
+
+OcclusionStats OcclusionCuller::readStats()
+{
+	if (slotFences[slot])
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffers[slot]);
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &slotStats[slot].occluded);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glDeleteSync(slotFences[slot]);
+		slotFences[slot] = 0;
+	}
+	lastStats = slotStats[slot];
+	return lastStats;
+}
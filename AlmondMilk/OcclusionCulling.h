@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include <GL/glew.h>        // GLEW library
+
+// GLM Libraries
+#include <glm/glm.hpp>
+
+#include "RenderState.h"
+#include "ScenePool.h"
+
+// Occlusion results of one culled frame
+struct OcclusionStats
+{
+	unsigned int tested = 0;			// Opaque instances tested against the Hi-Z pyramid
+	unsigned int occluded = 0;			// Instances found hidden and left out of the draws
+	unsigned int occluderInstances = 0;	// Instances drawn into the depth-only occluder pass
+};
+
+// std430 layout of one batch in the cull shader: mesh bounds as stored and the batch's instances
+struct CullBatch
+{
+	glm::vec4 boundsMin;
+	glm::vec4 boundsMax;
+	GLuint firstInstance;
+	GLuint instanceCount;
+	GLuint tested;			// 0 keeps every instance in its place: transparent batches must keep their order
+	GLuint padding;
+};
+
+// Mark meshes whose bounding box diagonal is at least 'fraction' of the largest mesh's as occluders; for scene
+// files, which carry no occluder flags. Returns the number of meshes marked.
+int markLargeOccluders(ScenePool& pool, float fraction);
+
+// GPU occlusion culling with a hierarchical-Z pyramid. Opaque batches of meshes marked as occluders are drawn
+// depth-only at full resolution, their depth is reduced into a power-of-two mip chain holding the farthest depth
+// under each texel, and a compute shader tests the bounding box of every instance against the 2x2 texels of the
+// level that covers it. Visible instances are compacted into a buffer of their own and counted into one indirect
+// draw command per batch, so hidden instances are never shaded. Transparent batches are drawn whole, in their
+// sorted order. Needs OpenGL 4.3; runs on llvmpipe.
+class OcclusionCuller
+{
+public:
+	static bool supported();		// Compute shaders, storage buffers and multi-draw indirect
+	bool create();					// Compile the compute programs; false if either fails
+	void destroy();
+
+	// Draw the occluders depth-only, rebuild the pyramid and test every instance of the batches. Call after
+	// ScenePool::uploadInstances(), with the camera buffer holding the matrices the batches are drawn with and
+	// the scene program bound; reverseDepth is the depth convention in effect. The pyramid follows the size of the
+	// current viewport. Framebuffer, viewport and program are restored afterwards.
+	void cull(ScenePool& pool, RenderState& state, const DrawBatch* batches, size_t batchCount, bool reverseDepth);
+
+	// Draw the instances of the culled batches that passed, with the commands the shader wrote
+	void draw(ScenePool& pool, RenderState& state, const DrawBatch* batches, size_t batchCount);
+
+	const OcclusionStats& stats() const { return lastStats; }	// A frame culled two frames ago that the GPU has finished; never waits
+	OcclusionStats readStats();									// The last cull(); waits for the GPU
+
+	int pyramidWidth() const { return hiZWidth; }
+	int pyramidHeight() const { return hiZHeight; }
+	int pyramidLevels() const { return hiZLevels; }
+
+private:
+	void resize(int width, int height);
+	void releaseTargets();
+
+	// Depth-only occluder target at viewport size
+	GLuint depthFramebuffer = 0;
+	GLuint depthTexture = 0;
+	int depthWidth = 0, depthHeight = 0;
+
+	// Farthest depth pyramid (R32F), level 0 the largest power of two inside the viewport
+	GLuint hiZTexture = 0;
+	int hiZWidth = 0, hiZHeight = 0, hiZLevels = 0;
+
+	GLuint reduceProgram = 0;
+	GLint reduceSourceLevel = -1, reduceReverse = -1;
+	GLuint cullProgram = 0;
+	GLint cullInstanceBase = -1, cullInstanceCount = -1, cullBatchCount = -1, cullLevels = -1, cullReverse = -1;
+
+	GLuint batchBuffer = 0;			// CullBatch per batch, rewritten every frame
+	GLuint commandBuffer = 0;		// Indirect command per batch; instance counts filled in by the shader
+	GLuint visibleBuffer = 0;		// Model matrices of the instances that passed, at their batch's first instance
+	GLsizeiptr visibleCapacity = 0;
+	GLint storageAlignment = 1;		// GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+
+	// Occluded counters, one per frame in flight, read back once the slot comes around again if its fence has passed
+	static const int counterSlots = 3;
+	GLuint counterBuffers[counterSlots] = {};
+	OcclusionStats slotStats[counterSlots];
+	GLsync slotFences[counterSlots] = {};		// Set after the slot's dispatch; 0 when there is nothing to read
+	int slot = 0;
+	OcclusionStats lastStats;
+
+	std::vector<DrawBatch> occluderBatches;
+	std::vector<CullBatch> cullBatches;
+	std::vector<DrawElementsIndirectCommand> commands;
+};
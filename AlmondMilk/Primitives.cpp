@@ -0,0 +1,163 @@
+#include "Primitives.h"
+
+// Define vertex data for triangles in a floating point array for PLANE
+const GLfloat planeVertices[] = {
+
+	-5.0, -5.0, -5.0,	1.0, 0.0, 0.0,
+	 5.0, -5.0, -5.0,	1.0, 0.0, 0.0,
+	 5.0, -5.0, 5.0,	1.0, 0.0, 0.0,
+	 5.0, -5.0, 5.0,	1.0, 0.0, 0.0,
+	-5.0, -5.0, 5.0,	1.0, 0.0, 0.0,
+	-5.0, -5.0, -5.0,	1.0, 0.0, 0.0
+};
+
+// Define vertex data for triangles in a floating point array for Almond Milk base cube
+const GLfloat milkCubeVertices[] = {
+
+	-2.0, -2.0, -2.0,		0.0, 1.0, 0.0,
+	 0.0, -2.0, -2.0,		0.0, 1.0, 0.0,
+	-2.0, -2.0,  0.0,		0.0, 1.0, 0.0,		// Top of Almond Milk cube
+	-2.0, -2.0,  0.0,		0.0, 1.0, 0.0,
+	 0.0, -2.0, -2.0,		0.0, 1.0, 0.0,
+	 0.0, -2.0,  0.0,		0.0, 1.0, 0.0,
+	
+	-2.0, -5.0, -2.0,		0.0, 1.0, 0.0,
+	 0.0, -5.0, -2.0,		0.0, 1.0, 0.0,
+	-2.0, -5.0, 0.0,		0.0, 1.0, 0.0,		// Bottom of Almond Milk cube
+	-2.0, -5.0, 0.0,		0.0, 1.0, 0.0,
+	 0.0, -5.0, -2.0,		0.0, 1.0, 0.0,
+	 0.0, -5.0, 0.0,		0.0, 1.0, 0.0,
+
+	-2.0, -2.0, 0.0,		0.0, 1.0, 0.0,
+	-2.0, -5.0, 0.0,		0.0, 1.0, 0.0,
+	 0.0, -5.0, 0.0,		0.0, 1.0, 0.0,		// Front of Almond Milk cube
+	 0.0, -5.0, 0.0,		0.0, 1.0, 0.0,
+	-2.0, -2.0, 0.0,		0.0, 1.0, 0.0,
+	 0.0, -2.0, 0.0,		0.0, 1.0, 0.0,
+
+	-2.0, -2.0, -2.0,		0.0, 1.0, 0.0,
+	-2.0, -5.0, -2.0,		0.0, 1.0, 0.0,
+	 0.0, -2.0, -2.0,		0.0, 1.0, 0.0,		// Back of Almond Milk cube
+	 0.0, -5.0, -2.0,		0.0, 1.0, 0.0,
+	 0.0, -2.0, -2.0,		0.0, 1.0, 0.0,
+	-2.0, -5.0, -2.0,		0.0, 1.0, 0.0,
+	
+	-2.0, -2.0, -2.0,		0.0, 1.0, 0.0,
+	-2.0, -2.0, 0.0,		0.0, 1.0, 0.0,
+	-2.0, -5.0, 0.0,		0.0, 1.0, 0.0,		// Left side of Almond Milk cube
+	-2.0, -2.0, -2.0,		0.0, 1.0, 0.0,
+	-2.0, -5.0, -2.0,		0.0, 1.0, 0.0,
+	-2.0, -5.0, 0.0,		0.0, 1.0, 0.0,
+
+	 0.0, -2.0,  0.0,		0.0, 1.0, 0.0,
+	 0.0, -5.0, -2.0,		0.0, 1.0, 0.0, 
+	 0.0, -5.0,  0.0,		0.0, 1.0, 0.0,		// Right side of Almond Milk cube
+	 0.0, -2.0,  0.0,		0.0, 1.0, 0.0,
+	 0.0, -2.0, -2.0,		0.0, 1.0, 0.0,
+	 0.0, -5.0, -2.0,		0.0, 1.0, 0.0
+};
+
+// Define vertex data for triangles in a floating point array for Almond Milk top pyramids
+const GLfloat milkCPyramidVertices[] = {
+
+	-2.0, -2.0, -2.0,		0.0, 0.0, 1.0,
+	-1.0, -2.0,  0.0,		0.0, 0.0, 1.0,
+	-2.0, -2.0,  0.0,		0.0, 0.0, 1.0,		// Bottom of left Almond Milk pyramid NOT SEEEN
+	-2.0, -2.0, -2.0,		0.0, 0.0, 1.0,
+	-1.0, -2.0,  0.0,		0.0, 0.0, 1.0,
+	-1.0, -2.0, -2.0,		0.0, 0.0, 1.0,
+
+	-2.0, -2.0, -2.0,		1.0, 0.0, 0.0,
+	-2.0, -2.0,  0.0,		1.0, 0.0, 0.0,
+	-1.5, -0.5, -1.0,		1.0, 0.0, 0.0,		// Left side of left Almond Milk pyramid RED
+
+	-2.0, -2.0, -2.0,		0.0, 1.0, 1.0,
+	-1.0, -2.0, -2.0,		0.0, 1.0, 1.0,
+	-1.5, -0.5, -1.0,		0.0, 1.0, 1.0,		// Back side of left Almond Milk pyramid CYAN
+
+	-1.0, -2.0, -2.0,		0.0, 0.0, 1.0,
+	-1.0, -2.0,  0.0,		0.0, 0.0, 1.0,
+	-1.5, -0.5, -1.0,		0.0, 0.0, 1.0,		// Right side of left Almond Milk pyramid NOT SEEEN
+
+	-2.0, -2.0, 0.0,		1.0, 0.0, 1.0,
+	-1.0, -2.0,  0.0,		1.0, 0.0, 1.0,
+	-1.5, -0.5, -1.0,		1.0, 0.0, 1.0,		// Front side of left Almond Milk pyramid PURPLE
+
+	-1.0, -2.0, -2.0,		0.0, 1.0, 1.0,
+	-1.0, -2.0,  0.0,		0.0, 1.0, 1.0, 
+	 0.0, -2.0,  0.0,		0.0, 1.0, 1.0,		// Bottom of right Almond Milk pyramid NOT SEEEN
+	-1.0, -2.0, -2.0,		0.0, 1.0, 1.0,
+	 0.0, -2.0,  0.0,		0.0, 1.0, 1.0,
+	 0.0, -2.0, -2.0,		0.0, 1.0, 1.0,
+
+	-1.0, -2.0,  0.0,		0.0, 1.0, 1.0,
+	-1.0, -2.0, -2.0,		0.0, 1.0, 1.0,
+	-0.5, -0.5, -1.0,		0.0, 1.0, 1.0,		// Left side of right Almond Milk pyramid NOT SEEEN
+
+	-1.0, -2.0, -2.0,		0.0, 1.0, 1.0,
+	 0.0, -2.0, -2.0,		0.0, 1.0, 1.0,
+	-0.5, -0.5, -1.0,		0.0, 1.0, 1.0,		// Back side of right Almond Milk pyramid CYAN
+
+	 0.0, -2.0, -2.0,		1.0, 0.0, 0.0,
+	 0.0, -2.0,  0.0,		1.0, 0.0, 0.0,
+	-0.5, -0.5, -1.0,		1.0, 0.0, 0.0,		// Right side of right Almond Milk pyramid RED
+
+	 0.0, -2.0,  0.0,		1.0, 0.0, 1.0,
+	-1.0, -2.0,  0.0,		1.0, 0.0, 1.0,
+	-0.5, -0.5, -1.0,		1.0, 0.0, 1.0,		// Front side of right Almond Milk pyramid PURPLE
+
+	-1.0, -2.0,  0.0,		1.0, 0.0, 1.0,
+	-1.5, -0.5, -1.0,		1.0, 0.0, 1.0,
+	-0.5, -0.5, -1.0,		1.0, 0.0, 1.0,		// Front triangle connecting both pyramids PURPLE
+
+	 -1, -2.0,  -2.0,		0.0, 1.0, 1.0,
+	-1.5, -0.5, -1.0,		0.0, 1.0, 1.0,
+	-0.5, -0.5, -1.0,		0.0, 1.0, 1.0		// Back triangle connecting both pyramids CYAN
+
+};
+
+// Define vertex data for triangles in a floating point array for Donut box 
+const GLfloat donutBoxVertices[] =
+{
+	1.0, -5.0, 0.0,		0.5, 0.5, 0.5,
+	2.5, -5.0, -1.5,	0.5, 0.5, 0.5,
+	3.0, -5.0, 2.0,		0.5, 0.5, 0.5,
+	3.0, -5.0, 2.0,		0.5, 0.5, 0.5,		// Bottom of donut box cube
+	4.5, -5.0, 0.5,		0.5, 0.5, 0.5,
+	2.5, -5.0, -1.5,	0.5, 0.5, 0.5,
+
+	1.0, -4.0, 0.0,		0.5, 0.5, 0.5,
+	2.5, -4.0, -1.5,	0.5, 0.5, 0.5,
+	3.0, -4.0, 2.0,		0.5, 0.5, 0.5,
+	3.0, -4.0, 2.0,		0.5, 0.5, 0.5,		// Top of donut box cube
+	4.5, -4.0, 0.5,		0.5, 0.5, 0.5,
+	2.5, -4.0, -1.5,	0.5, 0.5, 0.5,
+
+	1.0, -5.0, 0.0,		0.5, 0.5, 0.5,
+	1.0, -4.0, 0.0,		0.5, 0.5, 0.5,
+	3.0, -5.0, 2.0,		0.5, 0.5, 0.5,		// Front of donut box cube
+	3.0, -5.0, 2.0,		0.5, 0.5, 0.5,
+	1.0, -4.0, 0.0,		0.5, 0.5, 0.5,
+	3.0, -4.0, 2.0,		0.5, 0.5, 0.5,
+
+	3.0, -5.0, 2.0,		0.5, 0.5, 0.5,
+	3.0, -4.0, 2.0,		0.5, 0.5, 0.5,
+	4.5, -5.0, 0.5,		0.5, 0.5, 0.5,		// Right side of donut box cube
+	4.5, -5.0, 0.5,		0.5, 0.5, 0.5,
+	3.0, -4.0, 2.0,		0.5, 0.5, 0.5,
+	4.5, -4.0, 0.5,		0.5, 0.5, 0.5,
+
+	1.0, -5.0, 0.0,		0.5, 0.5, 0.5,
+	1.0, -4.0, 0.0,		0.5, 0.5, 0.5,
+	2.5, -5.0, -1.5,	0.5, 0.5, 0.5,		// Left side of donut box cube
+	2.5, -5.0, -1.5,	0.5, 0.5, 0.5,
+	1.0, -4.0, 0.0,		0.5, 0.5, 0.5,
+	2.5, -4.0, -1.5,	0.5, 0.5, 0.5,
+
+	2.5, -5.0, -1.5,	0.5, 0.5, 0.5,
+	2.5, -4.0, -1.5,	0.5, 0.5, 0.5,
+	4.5, -5.0, 0.5,		0.5, 0.5, 0.5,	// Back side of donut box cube
+	4.5, -5.0, 0.5,		0.5, 0.5, 0.5,
+	2.5, -4.0, -1.5,	0.5, 0.5, 0.5,
+	4.5, -4.0, 0.5,		0.5, 0.5, 0.5
+};
@@ -0,0 +1,17 @@
+#pragma once
+#include <GL/glew.h>        // GLEW library
+
+// Interleaved vertex layout used by every primitive: x, y, z, r, g, b
+const GLsizei floatsPerVertex = 6;
+
+// Hand-written scene primitives drawn as GL_TRIANGLES
+extern const GLfloat planeVertices[6 * floatsPerVertex];
+extern const GLfloat milkCubeVertices[36 * floatsPerVertex];
+extern const GLfloat milkCPyramidVertices[42 * floatsPerVertex];
+extern const GLfloat donutBoxVertices[36 * floatsPerVertex];
+
+// Number of vertices in each primitive
+const GLsizei planeVertexCount = sizeof(planeVertices) / (floatsPerVertex * sizeof(GLfloat));
+const GLsizei milkCubeVertexCount = sizeof(milkCubeVertices) / (floatsPerVertex * sizeof(GLfloat));
+const GLsizei milkCPyramidVertexCount = sizeof(milkCPyramidVertices) / (floatsPerVertex * sizeof(GLfloat));
+const GLsizei donutBoxVertexCount = sizeof(donutBoxVertices) / (floatsPerVertex * sizeof(GLfloat));
@@ -0,0 +1,193 @@
+#include "Profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+bool profilerEnabled = false;
+ProfileRing profileEvents;
+GpuProfiler gpuProfiler;
+
+static const chrono::steady_clock::time_point profileEpoch = chrono::steady_clock::now();
+
+unsigned long long profileNow()
+{
+	return (unsigned long long)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - profileEpoch).count();
+}
+
+unsigned int profileThreadId()
+{
+	static atomic<unsigned int> nextId(1);
+	thread_local unsigned int id = nextId.fetch_add(1);
+	return id;
+}
+
+ProfileRing::ProfileRing() : slots(capacity), writeIndex(0)
+{
+	for (Slot& slot : slots)
+	{
+		slot.sequence.store(0, memory_order_relaxed);
+	}
+}
+
+void ProfileRing::push(const ProfileEvent& event)
+{
+	unsigned long long index = writeIndex.fetch_add(1, memory_order_relaxed);
+	Slot& slot = slots[index & (capacity - 1)];
+	slot.sequence.store(2 * index + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	slot.event = event;
+	slot.sequence.store(2 * index + 2, memory_order_release);
+}
+
+void ProfileRing::snapshot(vector<ProfileEvent>& events) const
+{
+	events.clear();
+	unsigned long long end = writeIndex.load(memory_order_acquire);
+	unsigned long long begin = end > capacity ? end - capacity : 0;
+	for (unsigned long long index = begin; index < end; index++)
+	{
+		const Slot& slot = slots[index & (capacity - 1)];
+		unsigned long long before = slot.sequence.load(memory_order_acquire);
+		ProfileEvent event = slot.event;
+		atomic_thread_fence(memory_order_acquire);
+		if (before == 2 * index + 2 && slot.sequence.load(memory_order_relaxed) == before)
+		{
+			events.push_back(event);
+		}
+	}
+}
+
+CpuProfileScope::~CpuProfileScope()
+{
+	if (profilerEnabled && start != 0)
+	{
+		ProfileEvent event;
+		event.name = scopeName;
+		event.start = start;
+		event.duration = profileNow() - start;
+		event.thread = profileThreadId();
+		profileEvents.push(event);
+	}
+}
+
+void GpuProfiler::init()
+{
+	// Timestamp queries are core in GL 3.3; GL_TIME_ELAPSED cannot nest, so scopes use query counter pairs
+	supported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+	if (!supported)
+	{
+		return;
+	}
+	for (QuerySet& set : sets)
+	{
+		glGenQueries(maxScopesPerFrame * 2, set.queries);
+		set.count = 0;
+	}
+
+	// Line the GPU clock up with the CPU profiler clock
+	GLint64 gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+	gpuToCpu = (long long)profileNow() - (long long)gpuNow;
+}
+
+void GpuProfiler::beginFrame()
+{
+	if (!supported)
+	{
+		return;
+	}
+	current = 1 - current;
+	QuerySet& set = sets[current];
+	if (set.count > 0)
+	{
+		// Results come back in order, so the last end query tells whether the whole set is ready
+		GLint available = 0;
+		glGetQueryObjectiv(set.queries[set.count * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			for (int i = 0; i < set.count; i++)
+			{
+				GLuint64 begin = 0, end = 0;
+				glGetQueryObjectui64v(set.queries[i * 2], GL_QUERY_RESULT, &begin);
+				glGetQueryObjectui64v(set.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+				ProfileEvent event;
+				event.name = set.names[i];
+				event.start = (unsigned long long)((long long)begin + gpuToCpu);
+				event.duration = end - begin;
+				event.thread = 0;
+				profileEvents.push(event);
+			}
+		}
+		else
+		{
+			dropped++;
+		}
+	}
+	set.count = 0;
+}
+
+int GpuProfiler::begin(const char* name)
+{
+	QuerySet& set = sets[current];
+	if (!profilerEnabled || !supported || set.count == maxScopesPerFrame)
+	{
+		return -1;
+	}
+	glQueryCounter(set.queries[set.count * 2], GL_TIMESTAMP);
+	set.names[set.count] = name;
+	return set.count++;
+}
+
+void GpuProfiler::end(int scope)
+{
+	if (scope >= 0)
+	{
+		glQueryCounter(sets[current].queries[scope * 2 + 1], GL_TIMESTAMP);
+	}
+}
+
+void GpuProfiler::destroy()
+{
+	if (!supported)
+	{
+		return;
+	}
+	for (QuerySet& set : sets)
+	{
+		glDeleteQueries(maxScopesPerFrame * 2, set.queries);
+		set.count = 0;
+	}
+	supported = false;
+}
+
+bool writeChromeTrace(const char* path)
+{
+	ofstream file(path);
+	if (!file)
+	{
+		cout << "Failed to write profile trace " << path << endl;
+		return false;
+	}
+
+	vector<ProfileEvent> events;
+	profileEvents.snapshot(events);
+
+	// Complete ("X") events in microseconds; the GPU gets its own named track
+	file << "{\"traceEvents\":[" << endl;
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+	file << "," << endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Main thread\"}}";
+	file.precision(3);
+	file << fixed;
+	for (const ProfileEvent& event : events)
+	{
+		file << "," << endl << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+			<< ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}";
+	}
+	file << endl << "]}" << endl;
+
+	cout << "Wrote " << events.size() << " profile events to " << path << endl;
+	return true;
+}
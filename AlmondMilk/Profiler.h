@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include <GL/glew.h>        // GLEW library
+
+// Scoped CPU and GPU timers for the render loop. Build with ALMOND_PROFILE=0 to compile every
+// PROFILE_* marker out entirely; otherwise markers only record while profilerEnabled is set.
+#ifndef ALMOND_PROFILE
+#define ALMOND_PROFILE 1
+#endif
+
+// One timed scope, in nanoseconds on the CPU profiler clock
+struct ProfileEvent
+{
+	const char* name;				// Must point to a string literal
+	unsigned long long start;
+	unsigned long long duration;
+	unsigned int thread;			// 0 is the GPU track
+};
+
+// Fixed-size ring of events. Any thread can push without locking; when full the oldest events are overwritten.
+// Each slot carries a sequence number so a reader can tell a finished slot from one being rewritten.
+class ProfileRing
+{
+public:
+	static const size_t capacity = 1 << 16;
+
+	ProfileRing();
+	void push(const ProfileEvent& event);
+	void snapshot(std::vector<ProfileEvent>& events) const;	// Oldest first, skipping slots still being written
+	void clear() { writeIndex.store(0, std::memory_order_relaxed); }
+
+private:
+	struct Slot
+	{
+		std::atomic<unsigned long long> sequence;	// 2 * index + 2 once event for index is complete, odd while writing
+		ProfileEvent event;
+	};
+
+	std::vector<Slot> slots;
+	std::atomic<unsigned long long> writeIndex;
+};
+
+extern bool profilerEnabled;
+extern ProfileRing profileEvents;
+
+unsigned long long profileNow();		// Nanoseconds since the profiler clock started
+unsigned int profileThreadId();			// Small id for the calling thread, starting at 1
+
+// Times the enclosing block on the CPU
+class CpuProfileScope
+{
+public:
+	explicit CpuProfileScope(const char* name) : scopeName(name), start(profilerEnabled ? profileNow() : 0) {}
+	~CpuProfileScope();
+
+private:
+	const char* scopeName;
+	unsigned long long start;
+};
+
+// GPU timestamp query pairs. Each frame uses one of two query sets, and a set is only read back two frames
+// later when its results are available, so reading never waits for the GPU.
+class GpuProfiler
+{
+public:
+	static const int maxScopesPerFrame = 64;
+
+	void init();					// Needs a current context; does nothing without timer query support
+	void beginFrame();				// Collect results from the set about to be reused
+	int begin(const char* name);	// Returns scope slot, or -1 when not recording
+	void end(int scope);
+	void destroy();
+	size_t droppedFrames() const { return dropped; }
+
+private:
+	struct QuerySet
+	{
+		GLuint queries[maxScopesPerFrame * 2];
+		const char* names[maxScopesPerFrame];
+		int count = 0;
+	};
+
+	QuerySet sets[2];
+	int current = 0;
+	bool supported = false;
+	long long gpuToCpu = 0;			// Offset from GL_TIMESTAMP to the CPU profiler clock
+	size_t dropped = 0;				// Frames whose queries were not ready in time
+};
+
+extern GpuProfiler gpuProfiler;
+
+// Times the GPU work submitted inside the enclosing block
+class GpuProfileScope
+{
+public:
+	explicit GpuProfileScope(const char* name) : scope(gpuProfiler.begin(name)) {}
+	~GpuProfileScope() { gpuProfiler.end(scope); }
+
+private:
+	int scope;
+};
+
+// Write recorded events as Chrome trace-event JSON (open in chrome://tracing or Perfetto)
+bool writeChromeTrace(const char* path);
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#if ALMOND_PROFILE
+#define PROFILE_SCOPE(name) CpuProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#endif
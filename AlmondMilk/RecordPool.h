@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Storage for long-lived records such as meshes and shader programs, addressed by index. Records are allocated
+// in blocks of 'BlockSize', so adding one never moves or copies the others and references to them stay valid.
+// clear() keeps the blocks for the records added afterwards.
+template <typename T, size_t BlockSize = 64>
+class RecordPool
+{
+public:
+	int add(const T& record = T())		// Returns the record's index
+	{
+		if (count == blocks.size() * BlockSize)
+		{
+			blocks.emplace_back(new T[BlockSize]);
+		}
+		(*this)[(int)count] = record;
+		return (int)count++;
+	}
+
+	T& operator[](int index) { return blocks[index / BlockSize][index % BlockSize]; }
+	const T& operator[](int index) const { return blocks[index / BlockSize][index % BlockSize]; }
+	size_t size() const { return count; }
+	void clear() { count = 0; }
+
+private:
+	std::vector<std::unique_ptr<T[]>> blocks;
+	size_t count = 0;
+};
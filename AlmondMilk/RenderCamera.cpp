@@ -0,0 +1,150 @@
+#include "RenderCamera.h"
+#include "Camera.h"
+
+#include <cstring>
+
+// GLM Libraries
+#include <glm/gtc/matrix_transform.hpp> 
+
+void RenderCamera::setPose(const glm::vec3& position, const glm::vec3& newFront, const glm::vec3& newUp)
+{
+	if (position == eye && newFront == front && newUp == up)
+	{
+		return;
+	}
+	eye = position;
+	front = newFront;
+	up = newUp;
+	viewDirty = viewProjectionDirty = true;
+	changes++;
+}
+
+void RenderCamera::setLens(float fovDegrees, bool perspective, bool reverseDepth)
+{
+	if (fovDegrees == lensFov && perspective == lensPerspective && reverseDepth == lensReverse)
+	{
+		return;
+	}
+	lensFov = fovDegrees;
+	lensPerspective = perspective;
+	lensReverse = reverseDepth;
+	projectionDirty = viewProjectionDirty = true;
+	changes++;
+}
+
+void RenderCamera::setViewport(int width, int height)
+{
+	if (width == viewportWidth && height == viewportHeight)
+	{
+		return;
+	}
+	viewportWidth = width;
+	viewportHeight = height;
+	projectionDirty = viewProjectionDirty = true;
+	changes++;
+}
+
+const glm::mat4& RenderCamera::view()
+{
+	if (viewDirty)
+	{
+		viewMatrix = glm::lookAt(eye, eye + front, up);
+		viewDirty = false;
+		matrixBuilds++;
+	}
+	return viewMatrix;
+}
+
+const glm::mat4& RenderCamera::projection()
+{
+	if (projectionDirty)
+	{
+		projectionMatrix = computeProjectionMatrix(viewportWidth, viewportHeight, lensFov, lensPerspective, lensReverse);
+		projectionDirty = false;
+		matrixBuilds++;
+	}
+	return projectionMatrix;
+}
+
+const glm::mat4& RenderCamera::viewProjection()
+{
+	if (viewProjectionDirty)
+	{
+		viewProjectionMatrix = projection() * view();
+		viewProjectionDirty = false;
+	}
+	return viewProjectionMatrix;
+}
+
+bool reverseDepthSupported()
+{
+	return GLEW_VERSION_4_5 || GLEW_ARB_clip_control;
+}
+
+void applyDepthConvention(bool reverseDepth)
+{
+	if (reverseDepth)
+	{
+		glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+		glClearDepth(0.0);
+		glDepthFunc(GL_GREATER);
+	}
+	else
+	{
+		if (reverseDepthSupported())
+		{
+			glClipControl(GL_LOWER_LEFT, GL_NEGATIVE_ONE_TO_ONE);
+		}
+		glClearDepth(1.0);
+		glDepthFunc(GL_LESS);
+	}
+}
+
+void CameraUniformBuffer::create()
+{
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, cameraBlockBinding, buffer);
+	valid = false;
+}
+
+void CameraUniformBuffer::destroy()
+{
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+	valid = false;
+}
+
+bool CameraUniformBuffer::update(const glm::mat4& view, const glm::mat4& projection)
+{
+	if (valid && memcmp(&view, &contents.view, sizeof(glm::mat4)) == 0 && memcmp(&projection, &contents.projection, sizeof(glm::mat4)) == 0)
+	{
+		return false;
+	}
+	contents.view = view;
+	contents.projection = projection;
+	contents.viewProjection = projection * view;
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &contents);
+	valid = true;
+	uploadCount++;
+	return true;
+}
+
+bool RedrawTracker::needsRedraw(unsigned int cameraVersion, bool sceneAnimating)
+{
+	if (forced || sceneAnimating || cameraVersion != drawnVersion)
+	{
+		forced = false;
+		drawnVersion = cameraVersion;
+		settledFrames = 0;
+	}
+	if (settledFrames >= settle)
+	{
+		skippedFrames++;
+		return false;
+	}
+	settledFrames++;
+	return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <GL/glew.h>        // GLEW library
+
+// GLM Libraries
+#include <glm/glm.hpp> 
+
+// Camera the renderer draws from: pose, lens and viewport. View, projection and view-projection are only
+// recomputed after a setter actually changed something they depend on, and version() changes exactly then.
+class RenderCamera
+{
+public:
+	void setPose(const glm::vec3& position, const glm::vec3& front, const glm::vec3& up);
+	void setLens(float fovDegrees, bool perspective, bool reverseDepth = false);
+	void setViewport(int width, int height);
+
+	const glm::mat4& view();
+	const glm::mat4& projection();
+	const glm::mat4& viewProjection();
+
+	const glm::vec3& position() const { return eye; }
+	float fov() const { return lensFov; }
+	bool perspective() const { return lensPerspective; }
+	bool reverseDepth() const { return lensReverse; }
+	unsigned int version() const { return changes; }			// Bumped whenever the matrices change
+	unsigned int recomputes() const { return matrixBuilds; }	// View and projection builds so far
+
+private:
+	glm::vec3 eye = glm::vec3(0.0f);
+	glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f);
+	glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+	float lensFov = 45.0f;
+	bool lensPerspective = true;
+	bool lensReverse = false;
+	int viewportWidth = 1, viewportHeight = 1;
+
+	bool viewDirty = true, projectionDirty = true, viewProjectionDirty = true;
+	glm::mat4 viewMatrix, projectionMatrix, viewProjectionMatrix;
+	unsigned int changes = 0;
+	unsigned int matrixBuilds = 0;
+};
+
+// Reverse-Z needs glClipControl: GL 4.5 or ARB_clip_control
+bool reverseDepthSupported();
+
+// Depth convention for everything drawn afterwards: standard OpenGL depth ([-1, 1] clip depth, cleared to 1,
+// nearer passes with GL_LESS) or reverse-Z ([0, 1] clip depth, cleared to 0, nearer passes with GL_GREATER).
+// Reverse-Z only pays off with a float depth buffer.
+void applyDepthConvention(bool reverseDepth);
+
+// Uniform block binding point of the shared Camera block in every program
+const GLuint cameraBlockBinding = 0;
+
+// std140 layout of the Camera uniform block in the shaders
+struct CameraBlock
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 viewProjection;
+};
+
+// One uniform buffer holding the camera matrices for every program, bound to cameraBlockBinding.
+// update() only uploads when the matrices differ from the ones already in the buffer.
+class CameraUniformBuffer
+{
+public:
+	void create();
+	void destroy();
+	bool update(const glm::mat4& view, const glm::mat4& projection);		// True if it uploaded
+	unsigned int uploads() const { return uploadCount; }
+
+private:
+	GLuint buffer = 0;
+	CameraBlock contents;
+	bool valid = false;				// contents match the buffer
+	unsigned int uploadCount = 0;
+};
+
+// Decides per frame whether anything on screen can have changed. After the camera version changes, the
+// scene animates or a redraw is requested, 'settleFrames' more frames are drawn (one per frame in flight)
+// so the presented image shows the final state; after that frames are skipped until the next change.
+class RedrawTracker
+{
+public:
+	explicit RedrawTracker(int settleFrames) : settle(settleFrames) {}
+
+	bool needsRedraw(unsigned int cameraVersion, bool sceneAnimating);	// Call once per frame
+	void requestRedraw() { forced = true; }							// Window exposed, resized or damaged
+	unsigned long long skipped() const { return skippedFrames; }
+
+private:
+	int settle;
+	int settledFrames = 0;			// Frames drawn since the last change
+	unsigned int drawnVersion = 0;
+	bool forced = true;				// The first frame is always drawn
+	unsigned long long skippedFrames = 0;
+};
@@ -0,0 +1,43 @@
+#include "RenderState.h"
+
+void RenderState::beginFrame()
+{
+	counters = RenderCounters();
+}
+
+void RenderState::useProgram(GLuint program)
+{
+	if (program == currentProgram)
+	{
+		counters.elided++;
+		return;
+	}
+	glUseProgram(program);
+	currentProgram = program;
+	counters.issued++;
+}
+
+void RenderState::bindVertexArray(GLuint vao)
+{
+	if (vaoKnown && vao == currentVAO)
+	{
+		counters.elided++;
+		return;
+	}
+	glBindVertexArray(vao);
+	currentVAO = vao;
+	vaoKnown = true;
+	counters.issued++;
+}
+
+void RenderState::countIssued(unsigned int calls)
+{
+	counters.issued += calls;
+}
+
+void RenderState::invalidate()
+{
+	currentProgram = 0;
+	glUseProgram(0);
+	vaoKnown = false;
+}
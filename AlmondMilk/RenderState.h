@@ -0,0 +1,30 @@
+#pragma once
+#include <GL/glew.h>        // GLEW library
+
+// Program and VAO binds plus draw calls issued to the driver, versus binds dropped because the state was already
+// set. Buffer binds, uploads, dispatches and blits made outside the render state are not counted.
+struct RenderCounters
+{
+	unsigned int issued = 0;
+	unsigned int elided = 0;
+};
+
+// Tracks the bound program and VAO so redundant GL calls never reach the driver
+class RenderState
+{
+public:
+	void beginFrame();								// Reset per-frame counters
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vao);
+	void countIssued(unsigned int calls = 1);		// Record calls made directly, e.g. draws
+	void invalidate();								// Forget cached state after GL was touched behind our back
+
+	GLuint program() const { return currentProgram; }
+	const RenderCounters& frameCounters() const { return counters; }
+
+private:
+	GLuint currentProgram = 0;
+	GLuint currentVAO = 0;
+	bool vaoKnown = false;
+	RenderCounters counters;
+};
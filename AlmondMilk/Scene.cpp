@@ -0,0 +1,276 @@
+#include "Scene.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+
+int Scene::addObject(int mesh, const glm::mat4& model)
+{
+	SceneObject object;
+	object.mesh = mesh;
+	object.model = model;
+	sceneObjects.push_back(object);
+	bvhDirty = true;
+	return (int)sceneObjects.size() - 1;
+}
+
+void Scene::setModel(int object, const glm::mat4& model)
+{
+	sceneObjects[object].model = model;
+	bvhDirty = true;
+}
+
+int Scene::addLodChain(const LodChain& chain)
+{
+	lodChains.push_back(chain);
+	return (int)lodChains.size() - 1;
+}
+
+int Scene::addLodObject(int chain, const glm::mat4& model)
+{
+	// The finest level gives the bounds used for culling
+	int id = addObject(lodChains[chain].meshes[0], model);
+	sceneObjects[id].lodChain = chain;
+	return id;
+}
+
+void Scene::setLodView(const glm::vec3& eye, float fovDegrees)
+{
+	lodEye = eye;
+	lodFov = fovDegrees;
+}
+
+int Scene::addDynamicObject(const ScenePool& pool, int mesh, const glm::vec3& position, const glm::vec3& axis, float angle, const glm::vec3& scale)
+{
+	dynamicMesh.push_back(mesh);
+	return (int)dynamicObjects.add(position, axis, angle, scale, pool.mesh(mesh).bounds);
+}
+
+void Scene::buildBVH(const ScenePool& pool)
+{
+	worldBounds.resize(sceneObjects.size());
+	for (size_t i = 0; i < sceneObjects.size(); i++)
+	{
+		worldBounds[i] = transformAABB(pool.mesh(sceneObjects[i].mesh).bounds, sceneObjects[i].model);
+	}
+	bvh.build(worldBounds);
+	bvhDirty = false;
+}
+
+void Scene::cull(const ScenePool& pool, const glm::mat4& viewProjection, JobSystem* jobs)
+{
+	if (bvhDirty)
+	{
+		buildBVH(pool);
+	}
+	Frustum frustum = extractFrustum(viewProjection);
+	visible.clear();
+	if (jobs == nullptr || jobs->threadCount() == 1)
+	{
+		bvh.cull(frustum, visible);
+		updateDynamic(frustum, nullptr);
+		return;
+	}
+
+	// A few subtrees per thread so uneven subtrees still balance out
+	bvh.subtrees(jobs->threadCount() * 4, cullRoots);
+	subtreeVisible.resize(cullRoots.size());
+	JobCounter counter;
+	for (size_t i = 0; i < cullRoots.size(); i++)
+	{
+		jobs->run(counter, [this, &frustum, i]()
+		{
+			subtreeVisible[i].clear();
+			bvh.cull(frustum, subtreeVisible[i], cullRoots[i]);
+		});
+	}
+	updateDynamic(frustum, jobs);
+	jobs->wait(counter);
+	for (const std::vector<int>& ids : subtreeVisible)
+	{
+		visible.insert(visible.end(), ids.begin(), ids.end());
+	}
+}
+
+void Scene::updateDynamic(const Frustum& frustum, JobSystem* jobs)
+{
+	dynamicWorld.resize(dynamicObjects.size());
+	dynamicVisible.resize(dynamicObjects.size());
+	if (jobs == nullptr)
+	{
+		transformAndCull(dynamicObjects, frustum, dynamicWorld.data(), dynamicVisible.data());
+	}
+	else
+	{
+		// Ranges are a multiple of 8 so every job stays on the wide kernel path
+		jobs->parallelFor(dynamicObjects.size(), 4096, [this, &frustum](size_t first, size_t last)
+		{
+			transformAndCull(dynamicObjects, first, last - first, frustum, dynamicWorld.data(), dynamicVisible.data());
+		});
+	}
+
+	dynamicVisibleCount = 0;
+	for (unsigned char v : dynamicVisible)
+	{
+		dynamicVisibleCount += v;
+	}
+}
+
+void Scene::selectAll()
+{
+	visible.resize(sceneObjects.size());
+	for (size_t i = 0; i < visible.size(); i++)
+	{
+		visible[i] = (int)i;
+	}
+
+	// Planes with zero normal and positive offset accept every box
+	Frustum everything;
+	for (int p = 0; p < 6; p++)
+	{
+		everything.planes[p] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	updateDynamic(everything, nullptr);
+}
+
+int Scene::instanceMesh(size_t item)
+{
+	if (item >= visible.size())
+	{
+		size_t i = item - visible.size();
+		return dynamicVisible[i] ? dynamicMesh[i] : -1;
+	}
+
+	// Pick a level for LOD objects from the bounding sphere scaled by the model matrix
+	const SceneObject& object = sceneObjects[visible[item]];
+	if (object.lodChain < 0)
+	{
+		return object.mesh;
+	}
+	const LodChain& chain = lodChains[object.lodChain];
+	float scale = std::max(glm::length(glm::vec3(object.model[0])), std::max(glm::length(glm::vec3(object.model[1])), glm::length(glm::vec3(object.model[2]))));
+	float distance = glm::length(glm::vec3(object.model[3]) - lodEye);
+	return chain.meshes[selectLod(chain.radius * scale, distance, lodFov, (int)chain.meshes.size())];
+}
+
+void Scene::buildInstances(const ScenePool& pool, DrawList& list, JobSystem* jobs)
+{
+	auto sortStart = std::chrono::high_resolution_clock::now();
+	frameArena.beginFrame();
+
+	// Static visible objects then every dynamic object, split into ranges handled as separate jobs
+	size_t items = visible.size() + dynamicVisible.size();
+	size_t rangeSize = items;
+	if (jobs != nullptr && jobs->threadCount() > 1)
+	{
+		rangeSize = std::max<size_t>(4096, items / (jobs->threadCount() * 4) + 1);
+	}
+	auto forEachRange = [&](size_t count, const auto& body)
+	{
+		if (jobs == nullptr || count <= rangeSize)
+		{
+			body(0, count);
+			return;
+		}
+		jobs->parallelFor(count, rangeSize, body);
+	};
+
+	// Key every object; culled dynamic objects get a key that sorts after everything and is dropped below.
+	// Depth buckets are filled in once the distance range of this frame's objects is known.
+	const DrawKey culled = ~(DrawKey)0;
+	ArenaArray<DrawKey> sortKeys = frameArena.allocateArray<DrawKey>(items);
+	ArenaArray<float> distances = frameArena.allocateArray<float>(items);
+	forEachRange(items, [&](size_t first, size_t last)
+	{
+		for (size_t item = first; item < last; item++)
+		{
+			int mesh = instanceMesh(item);
+			if (mesh < 0)
+			{
+				sortKeys[item] = culled;
+				continue;
+			}
+			const MeshRange& range = pool.mesh(mesh);
+			const glm::mat4& model = item < visible.size() ? sceneObjects[visible[item]].model : dynamicWorld[item - visible.size()];
+			glm::vec3 center = glm::vec3(model * glm::vec4((range.bounds.min + range.bounds.max) * 0.5f, 1.0f));
+			RenderPass pass = range.transparent ? TransparentPass : OpaquePass;
+			distances[item] = glm::length(center - lodEye);
+			sortKeys[item] = makeDrawKey(pass, range.program, pool.vertexArray(), range.material, 0, mesh);
+		}
+	});
+
+	// Buckets span the objects actually drawn, not the clip range: an infinite far plane has no end to divide
+	float nearest = FLT_MAX, farthest = 0.0f;
+	for (size_t item = 0; item < items; item++)
+	{
+		if (sortKeys[item] != culled)
+		{
+			nearest = std::min(nearest, distances[item]);
+			farthest = std::max(farthest, distances[item]);
+		}
+	}
+	nearest = std::max(nearest, 0.1f);
+	farthest = std::max(farthest, nearest * 2.0f);
+	forEachRange(items, [&](size_t first, size_t last)
+	{
+		for (size_t item = first; item < last; item++)
+		{
+			DrawKey key = sortKeys[item];
+			if (key != culled)
+			{
+				unsigned int bucket = depthBucket(distances[item], nearest, farthest, keyPass(key));
+				sortKeys[item] = makeDrawKey(keyPass(key), keyProgram(key), keyVertexArray(key), keyMaterial(key), bucket, keyMesh(key));
+			}
+		}
+	});
+
+	// Drop culled objects, keeping scene order for the unsorted state change count
+	size_t count = 0;
+	ArenaArray<unsigned int> sortItems = frameArena.allocateArray<unsigned int>(items);
+	for (size_t item = 0; item < items; item++)
+	{
+		if (sortKeys[item] != culled)
+		{
+			sortKeys[count] = sortKeys[item];
+			sortItems[count++] = (unsigned int)item;
+		}
+	}
+	list.sortStats.unsortedChanges = countStateChanges(sortKeys.data(), count);
+
+	radixSortKeys(sortKeys.data(), sortItems.data(), count, frameArena.allocateArray<DrawKey>(count).data(), frameArena.allocateArray<unsigned int>(count).data());
+	list.sortStats.sortedChanges = countStateChanges(sortKeys.data(), count);
+	list.sortStats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - sortStart).count();
+
+	// One batch per run of equal keys
+	size_t batchCount = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		batchCount += i == 0 || sortKeys[i] != sortKeys[i - 1];
+	}
+	list.batches = frameArena.allocateArray<DrawBatch>(batchCount);
+	size_t batch = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (i == 0 || sortKeys[i] != sortKeys[i - 1])
+		{
+			list.batches[batch].mesh = keyMesh(sortKeys[i]);
+			list.batches[batch].firstInstance = (GLuint)i;
+			list.batches[batch].instanceCount = 0;
+			list.batches[batch].key = sortKeys[i];
+			batch++;
+		}
+		list.batches[batch - 1].instanceCount++;
+	}
+
+	// Transforms in sorted order
+	list.transforms = frameArena.allocateArray<glm::mat4>(count);
+	forEachRange(count, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			size_t item = sortItems[i];
+			const glm::mat4& model = item < visible.size() ? sceneObjects[visible[item]].model : dynamicWorld[item - visible.size()];
+			list.transforms[i] = model * pool.mesh(keyMesh(sortKeys[i])).decode;
+		}
+	});
+}
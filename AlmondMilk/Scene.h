@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+
+// GLM Libraries
+#include <glm/glm.hpp> 
+
+#include "Culling.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "MeshGenerator.h"
+#include "ScenePool.h"
+#include "TransformKernel.h"
+
+// One drawable object: a mesh from the scene pool placed with a model matrix
+struct SceneObject
+{
+	int mesh;
+	glm::mat4 model;
+	int lodChain = -1;		// Scene LOD chain the drawn mesh is picked from, or -1 to always draw 'mesh'
+};
+
+// GL state changes of one frame's draws with and without sorting
+struct DrawSortStats
+{
+	unsigned int unsortedChanges = 0;		// Drawing every visible object on its own, in scene order
+	unsigned int sortedChanges = 0;			// Drawing the sorted batches
+	double sortMs = 0.0;					// Building and sorting the keys
+};
+
+// Everything the GL thread needs to submit one frame: camera matrices and the visible instances in draw order.
+// The arrays live in the scene's frame arena and stay valid until the scene builds its second list after this one.
+struct DrawList
+{
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 projection = glm::mat4(1.0f);
+	ArenaArray<glm::mat4> transforms;		// Instance buffer contents, in batch order
+	ArenaArray<DrawBatch> batches;			// One batch per sort key: pass, state, depth bucket and mesh
+	DrawSortStats sortStats;
+};
+
+// Scene objects plus the per-frame instance transforms and draw batches built from them
+class Scene
+{
+public:
+	int addObject(int mesh, const glm::mat4& model);	// Returns object id
+	void setModel(int object, const glm::mat4& model);
+
+	// Objects drawing one level of a LOD chain, picked per frame by projected size
+	int addLodChain(const LodChain& chain);							// Returns chain id
+	int addLodObject(int chain, const glm::mat4& model);			// Returns object id
+	void setLodView(const glm::vec3& eye, float fovDegrees);		// Camera for LOD selection and depth sorting; fovDegrees 0 for orthographic
+
+	// Objects that move every frame skip the BVH; their transforms are rebuilt and culled in batches
+	// by the SIMD kernel. Place with translate(position) * rotate(angle, axis) * scale(scale).
+	int addDynamicObject(const ScenePool& pool, int mesh, const glm::vec3& position, const glm::vec3& axis, float angle, const glm::vec3& scale);	// Returns dynamic object id
+	TransformSoA& dynamicTransforms() { return dynamicObjects; }
+
+	// Rebuild the BVH if objects changed, then keep only objects inside the projection * view frustum.
+	// Dynamic objects are transformed and tested against the same frustum. With a job system, BVH subtrees
+	// and ranges of dynamic objects are culled as separate jobs.
+	void cull(const ScenePool& pool, const glm::mat4& viewProjection, JobSystem* jobs = nullptr);
+	void selectAll();		// Skip culling; every object is visible until the next cull
+
+	// Pick LOD meshes, give every visible object a DrawKey and radix sort them, then fill one transform per
+	// instance (model * mesh decode) and one batch per distinct key. Opaque objects come front to back by depth
+	// bucket, transparent ones back to front after them; buckets are log-spaced over the distances of this frame's
+	// visible objects. With a job system, ranges of objects get their keys
+	// and transforms as separate jobs; the result is the same. Every call starts a frame of the scene's arena.
+	void buildInstances(const ScenePool& pool, JobSystem* jobs = nullptr) { buildInstances(pool, frameList, jobs); }
+	void buildInstances(const ScenePool& pool, DrawList& list, JobSystem* jobs = nullptr);
+
+	const std::vector<SceneObject>& objects() const { return sceneObjects; }
+	size_t objectCount() const { return sceneObjects.size() + dynamicObjects.size(); }
+	size_t visibleCount() const { return visible.size() + dynamicVisibleCount; }
+	const ArenaArray<glm::mat4>& instanceTransforms() const { return frameList.transforms; }
+	const ArenaArray<DrawBatch>& drawBatches() const { return frameList.batches; }
+	const DrawSortStats& sortStats() const { return frameList.sortStats; }
+	const ArenaStats& arenaStats() const { return frameArena.stats(); }
+
+private:
+	void buildBVH(const ScenePool& pool);
+	void updateDynamic(const Frustum& frustum, JobSystem* jobs);
+	int instanceMesh(size_t item);			// Mesh of visible object 'item', dynamic objects after static ones; -1 if culled
+
+	std::vector<SceneObject> sceneObjects;
+	std::vector<AABB> worldBounds;			// World-space bounds per object
+	BVH bvh;
+	bool bvhDirty = true;					// Objects moved or were added since the last build
+	std::vector<int> visible;				// Objects that passed the last cull
+	std::vector<LodChain> lodChains;
+	glm::vec3 lodEye = glm::vec3(0.0f);
+	float lodFov = 0.0f;					// Full detail until a view is set
+	TransformSoA dynamicObjects;
+	std::vector<int> dynamicMesh;			// Mesh per dynamic object
+	std::vector<glm::mat4> dynamicWorld;	// Model matrices written by the kernel
+	std::vector<unsigned char> dynamicVisible;
+	size_t dynamicVisibleCount = 0;
+	DrawList frameList;						// Filled by buildInstances() without a list of its own
+	FrameArena frameArena;					// Sort scratch and draw lists; one region for the list being built, one for the list being submitted
+	std::vector<int> cullRoots;				// BVH subtrees culled as separate jobs
+	std::vector<std::vector<int>> subtreeVisible;
+};
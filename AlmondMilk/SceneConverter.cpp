@@ -0,0 +1,60 @@
+#include "SceneConverter.h"
+#include "DemoScene.h"
+#include "ObjLoader.h"
+#include "Scene.h"
+#include "ScenePool.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+static SceneFileObject makeFileObject(int mesh, const glm::mat4& model)
+{
+	SceneFileObject object = {};
+	object.mesh = (GLuint)mesh;
+	memcpy(object.model, &model[0][0], sizeof(object.model));
+	return object;
+}
+
+int convertScene(const string& outputPath, const vector<string>& objPaths, bool compactVertices)
+{
+	ScenePool pool(compactVertices);
+	vector<SceneFileObject> objects;
+
+	if (objPaths.empty())
+	{
+		Scene scene;
+		DemoMeshes meshes = addDemoMeshes(pool, false);
+		populateDemoScene(scene, pool, meshes, 0);
+		for (const SceneObject& object : scene.objects())
+		{
+			objects.push_back(makeFileObject(object.mesh, object.model));
+		}
+	}
+	else
+	{
+		for (const string& path : objPaths)
+		{
+			IndexedMesh mesh;
+			if (!loadObjMesh(path, mesh))
+			{
+				return 1;
+			}
+			mesh.acmrWelded = computeACMR(mesh.indices, mesh.vertexCount());
+			optimizeVertexCache(mesh.indices, mesh.vertexCount());
+			mesh.acmrAfter = computeACMR(mesh.indices, mesh.vertexCount());
+			cout << path << ": " << mesh.vertexCount() << " vertices, " << mesh.indexCount() / 3 << " triangles, ACMR "
+				<< mesh.acmrWelded << " -> " << mesh.acmrAfter << endl;
+			objects.push_back(makeFileObject(pool.addMesh(mesh), glm::mat4(1.0f)));
+		}
+	}
+
+	if (!pool.save(outputPath, objects))
+	{
+		return 1;
+	}
+	cout << "Wrote " << outputPath << ": " << pool.meshCount() << " meshes, " << objects.size() << " objects, "
+		<< (compactVertices ? "compact" : "float") << " vertices" << endl;
+	return 0;
+}
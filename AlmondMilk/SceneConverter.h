@@ -0,0 +1,8 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Write a binary scene file (see SceneFile.h). With no OBJ paths the built-in primitives are written,
+// placed as in the interactive scene; otherwise every OBJ file becomes one mesh drawn once at the origin.
+// OBJ meshes are reordered for the vertex cache before writing, so loading does no mesh processing.
+int convertScene(const std::string& outputPath, const std::vector<std::string>& objPaths, bool compactVertices);
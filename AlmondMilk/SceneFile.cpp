@@ -0,0 +1,201 @@
+#include "SceneFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+bool MappedFile::open(const string& path)
+{
+	close();
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(handle);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (!view)
+	{
+		if (mapping)
+		{
+			CloseHandle(mapping);
+		}
+		CloseHandle(handle);
+		return false;
+	}
+	fileHandle = handle;
+	mappingHandle = mapping;
+	bytes = (const unsigned char*)view;
+	length = (size_t)fileSize.QuadPart;
+#else
+	int descriptor = ::open(path.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(descriptor, &info) != 0 || info.st_size == 0)
+	{
+		::close(descriptor);
+		return false;
+	}
+	void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	::close(descriptor);		// The mapping keeps the file alive
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+	madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+	bytes = (const unsigned char*)view;
+	length = (size_t)info.st_size;
+#endif
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (!bytes)
+	{
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(bytes);
+	CloseHandle(mappingHandle);
+	CloseHandle(fileHandle);
+	fileHandle = mappingHandle = nullptr;
+#else
+	munmap((void*)bytes, length);
+#endif
+	bytes = nullptr;
+	length = 0;
+}
+
+// True when [offset, offset + size) lies inside the file and starts on a 16-byte boundary
+static bool sectionFits(uint64_t offset, uint64_t size, uint64_t fileSize)
+{
+	return offset % 16 == 0 && offset <= fileSize && size <= fileSize - offset;
+}
+
+bool SceneFile::open(const string& path)
+{
+	if (!file.open(path))
+	{
+		cout << "Failed to map scene file " << path << endl;
+		return false;
+	}
+
+	const SceneFileHeader& h = header();
+	if (file.size() < sizeof(SceneFileHeader) || memcmp(h.magic, sceneFileMagic, 4) != 0)
+	{
+		cout << path << " is not a scene file" << endl;
+		close();
+		return false;
+	}
+	if (h.version != sceneFileVersion)
+	{
+		cout << "Scene file " << path << " is version " << h.version << ", expected " << sceneFileVersion << endl;
+		close();
+		return false;
+	}
+
+	GLuint expectedStride = h.vertexLayout == CompactVertices ? 12 : 6 * sizeof(GLfloat);
+	bool valid = h.vertexLayout <= CompactVertices && h.vertexStride == expectedStride && h.fileSize == file.size()
+		&& sectionFits(h.meshOffset, (uint64_t)h.meshCount * sizeof(SceneFileMesh), file.size())
+		&& sectionFits(h.objectOffset, (uint64_t)h.objectCount * sizeof(SceneFileObject), file.size())
+		&& sectionFits(h.vertexOffset, (uint64_t)h.vertexCount * h.vertexStride, file.size())
+		&& sectionFits(h.indexOffset, (uint64_t)h.indexCount * sizeof(GLuint), file.size());
+
+	// Table entries must stay inside the blobs; index values are trusted so no blob page is touched here
+	for (GLuint i = 0; valid && i < h.meshCount; i++)
+	{
+		const SceneFileMesh& mesh = meshes()[i];
+		valid = mesh.baseVertex >= 0 && mesh.vertexCount >= 0 && (uint64_t)mesh.baseVertex + mesh.vertexCount <= h.vertexCount
+			&& mesh.firstIndex >= 0 && mesh.indexCount >= 0 && (uint64_t)mesh.firstIndex + mesh.indexCount <= h.indexCount;
+	}
+	for (GLuint i = 0; valid && i < h.objectCount; i++)
+	{
+		valid = objects()[i].mesh < h.meshCount;
+	}
+
+	if (!valid)
+	{
+		cout << "Scene file " << path << " is corrupt" << endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+static uint64_t alignSection(uint64_t offset)
+{
+	return (offset + 15) & ~(uint64_t)15;
+}
+
+static void padTo(ofstream& out, uint64_t offset)
+{
+	static const char zeros[16] = {};
+	uint64_t position = (uint64_t)out.tellp();
+	out.write(zeros, (streamsize)(offset - position));
+}
+
+bool writeSceneFile(const string& path, SceneVertexLayout layout, GLuint vertexStride,
+	const vector<SceneFileMesh>& meshes, const vector<SceneFileObject>& objects,
+	const void* vertices, GLuint vertexCount, const GLuint* indices, GLuint indexCount)
+{
+	SceneFileHeader h = {};
+	memcpy(h.magic, sceneFileMagic, 4);
+	h.version = sceneFileVersion;
+	h.vertexLayout = layout;
+	h.vertexStride = vertexStride;
+	h.meshCount = (GLuint)meshes.size();
+	h.objectCount = (GLuint)objects.size();
+	h.vertexCount = vertexCount;
+	h.indexCount = indexCount;
+	h.meshOffset = alignSection(sizeof(SceneFileHeader));
+	h.objectOffset = alignSection(h.meshOffset + meshes.size() * sizeof(SceneFileMesh));
+	h.vertexOffset = alignSection(h.objectOffset + objects.size() * sizeof(SceneFileObject));
+	h.indexOffset = alignSection(h.vertexOffset + (uint64_t)vertexCount * vertexStride);
+	h.fileSize = h.indexOffset + (uint64_t)indexCount * sizeof(GLuint);
+
+	ofstream out(path, ios::binary | ios::trunc);
+	if (!out)
+	{
+		cout << "Failed to create scene file " << path << endl;
+		return false;
+	}
+	out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+	padTo(out, h.meshOffset);
+	out.write(reinterpret_cast<const char*>(meshes.data()), meshes.size() * sizeof(SceneFileMesh));
+	padTo(out, h.objectOffset);
+	out.write(reinterpret_cast<const char*>(objects.data()), objects.size() * sizeof(SceneFileObject));
+	padTo(out, h.vertexOffset);
+	out.write(reinterpret_cast<const char*>(vertices), (streamsize)vertexCount * vertexStride);
+	padTo(out, h.indexOffset);
+	out.write(reinterpret_cast<const char*>(indices), (streamsize)indexCount * sizeof(GLuint));
+	if (!out)
+	{
+		cout << "Failed to write scene file " << path << endl;
+		return false;
+	}
+	return true;
+}
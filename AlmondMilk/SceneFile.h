@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>        // GLEW library
+
+// Binary scene file (.amsc), version 1. Everything is little-endian and every section starts on a
+// 16-byte boundary, so a mapped file can be handed to glBufferData without parsing or copying:
+//
+//   SceneFileHeader
+//   SceneFileMesh[meshCount]        mesh table, ranges into the shared vertex and index blobs
+//   SceneFileObject[objectCount]    mesh id and model matrix per object
+//   vertex blob                     vertexCount * vertexStride bytes in the pool's vertex layout
+//   index blob                      indexCount GLuint indices, relative to each mesh's baseVertex
+const char sceneFileMagic[4] = { 'A', 'M', 'S', 'C' };
+const GLuint sceneFileVersion = 1;
+
+enum SceneVertexLayout
+{
+	FloatVertices = 0,		// x, y, z, r, g, b as floats (24 bytes)
+	CompactVertices = 1		// CompactVertex (12 bytes)
+};
+
+struct SceneFileHeader
+{
+	char magic[4];
+	GLuint version;
+	GLuint vertexLayout;		// SceneVertexLayout
+	GLuint vertexStride;
+	GLuint meshCount;
+	GLuint objectCount;
+	GLuint vertexCount;
+	GLuint indexCount;
+	std::uint64_t meshOffset;
+	std::uint64_t objectOffset;
+	std::uint64_t vertexOffset;
+	std::uint64_t indexOffset;
+	std::uint64_t fileSize;
+	std::uint64_t reserved;
+};
+
+struct SceneFileMesh
+{
+	GLint baseVertex;
+	GLint vertexCount;
+	GLint firstIndex;
+	GLint indexCount;
+	GLfloat decode[16];			// Column-major, see MeshRange::decode
+	GLfloat boundsMin[3];
+	GLfloat boundsMax[3];
+};
+
+struct SceneFileObject
+{
+	GLuint mesh;
+	GLuint reserved[3];
+	GLfloat model[16];			// Column-major
+};
+
+static_assert(sizeof(SceneFileHeader) == 80, "scene file header layout");
+static_assert(sizeof(SceneFileMesh) == 104, "scene file mesh layout");
+static_assert(sizeof(SceneFileObject) == 80, "scene file object layout");
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+	~MappedFile() { close(); }
+
+	bool open(const std::string& path);
+	void close();
+	const unsigned char* data() const { return bytes; }
+	size_t size() const { return length; }
+
+private:
+	const unsigned char* bytes = nullptr;
+	size_t length = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
+
+// Scene file mapped into memory. open() checks the header and that every table entry stays inside the blobs;
+// the accessors then point straight into the mapping.
+class SceneFile
+{
+public:
+	bool open(const std::string& path);
+	void close() { file.close(); }
+
+	const SceneFileHeader& header() const { return *reinterpret_cast<const SceneFileHeader*>(file.data()); }
+	bool compactVertices() const { return header().vertexLayout == CompactVertices; }
+	const SceneFileMesh* meshes() const { return reinterpret_cast<const SceneFileMesh*>(file.data() + header().meshOffset); }
+	const SceneFileObject* objects() const { return reinterpret_cast<const SceneFileObject*>(file.data() + header().objectOffset); }
+	const void* vertexData() const { return file.data() + header().vertexOffset; }
+	const GLuint* indexData() const { return reinterpret_cast<const GLuint*>(file.data() + header().indexOffset); }
+	size_t vertexBytes() const { return (size_t)header().vertexCount * header().vertexStride; }
+	size_t fileSize() const { return file.size(); }
+
+private:
+	MappedFile file;
+};
+
+// Write a scene file from in-memory tables and blobs
+bool writeSceneFile(const std::string& path, SceneVertexLayout layout, GLuint vertexStride,
+	const std::vector<SceneFileMesh>& meshes, const std::vector<SceneFileObject>& objects,
+	const void* vertices, GLuint vertexCount, const GLuint* indices, GLuint indexCount);
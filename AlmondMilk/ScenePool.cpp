@@ -0,0 +1,356 @@
+#include "ScenePool.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// GLM Libraries
+#include <glm/gtc/matrix_transform.hpp> 
+
+// Append mesh to pool and record its offsets and counts in the mesh table
+int ScenePool::addMesh(const IndexedMesh& mesh)
+{
+	MeshRange range;
+	range.baseVertex = totalVertices;
+	range.vertexCount = mesh.vertexCount();
+	range.firstIndex = totalIndices;
+	range.indexCount = mesh.indexCount();
+	range.decode = glm::mat4(1.0f);
+
+	// Model-space bounding box for culling
+	range.bounds.min = range.bounds.max = glm::vec3(0.0f);
+	for (GLsizei v = 0; v < range.vertexCount; v++)
+	{
+		const GLfloat* vertex = &mesh.vertices[v * floatsPerVertex];
+		glm::vec3 position(vertex[0], vertex[1], vertex[2]);
+		range.bounds.min = v == 0 ? position : glm::min(range.bounds.min, position);
+		range.bounds.max = v == 0 ? position : glm::max(range.bounds.max, position);
+	}
+
+	if (compact)
+	{
+		// Quantize against this mesh's bounding box; the box transform is folded into every instance matrix
+		QuantizedMesh quantized = quantizeMesh(mesh);
+		range.decode = glm::translate(glm::mat4(1.0f), quantized.dequantOffset);
+		range.decode = glm::scale(range.decode, quantized.dequantScale);
+		const GLubyte* bytes = (const GLubyte*)quantized.vertices.data();
+		vertexData.insert(vertexData.end(), bytes, bytes + quantized.vertices.size() * sizeof(CompactVertex));
+	}
+	else
+	{
+		const GLubyte* bytes = (const GLubyte*)mesh.vertices.data();
+		vertexData.insert(vertexData.end(), bytes, bytes + mesh.vertices.size() * sizeof(GLfloat));
+	}
+	indexData.insert(indexData.end(), mesh.indices.begin(), mesh.indices.end());
+	int id = meshes.add(range);
+	totalVertices += range.vertexCount;
+	totalIndices += range.indexCount;
+
+	return id;
+}
+
+// Create one VAO, one VBO and one EBO holding every mesh in the pool, plus the instance and indirect buffers
+void ScenePool::upload()
+{
+	uploadBuffers(vertexData.data(), vertexData.size(), indexData.data(), indexData.size());
+
+	// Geometry now lives on the GPU; release the CPU copy
+	std::vector<GLubyte>().swap(vertexData);
+	std::vector<GLuint>().swap(indexData);
+}
+
+bool ScenePool::save(const std::string& path, const std::vector<SceneFileObject>& objects) const
+{
+	std::vector<SceneFileMesh> table(meshes.size());
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		const MeshRange& range = meshes[(int)i];
+		table[i].baseVertex = range.baseVertex;
+		table[i].vertexCount = range.vertexCount;
+		table[i].firstIndex = range.firstIndex;
+		table[i].indexCount = range.indexCount;
+		memcpy(table[i].decode, &range.decode[0][0], sizeof(table[i].decode));
+		memcpy(table[i].boundsMin, &range.bounds.min.x, sizeof(table[i].boundsMin));
+		memcpy(table[i].boundsMax, &range.bounds.max.x, sizeof(table[i].boundsMax));
+	}
+	return writeSceneFile(path, compact ? CompactVertices : FloatVertices, vertexStride(), table, objects,
+		vertexData.data(), totalVertices, indexData.data(), totalIndices);
+}
+
+bool ScenePool::uploadFromFile(const SceneFile& file)
+{
+	if (file.compactVertices() != compact)
+	{
+		std::cout << "Scene file vertex layout does not match the pool" << std::endl;
+		return false;
+	}
+
+	const SceneFileHeader& header = file.header();
+	meshes.clear();
+	for (GLuint i = 0; i < header.meshCount; i++)
+	{
+		const SceneFileMesh& entry = file.meshes()[i];
+		MeshRange& range = meshes[meshes.add()];
+		range.baseVertex = entry.baseVertex;
+		range.vertexCount = entry.vertexCount;
+		range.firstIndex = entry.firstIndex;
+		range.indexCount = entry.indexCount;
+		memcpy(&range.decode[0][0], entry.decode, sizeof(entry.decode));
+		range.bounds.min = glm::vec3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]);
+		range.bounds.max = glm::vec3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]);
+	}
+	totalVertices = header.vertexCount;
+	totalIndices = header.indexCount;
+
+	// The driver copies straight out of the mapped pages
+	uploadBuffers(file.vertexData(), file.vertexBytes(), file.indexData(), header.indexCount);
+	return true;
+}
+
+void ScenePool::uploadBuffers(const void* vertices, GLsizeiptr vertexBytes, const GLuint* indices, GLsizeiptr indexCount)
+{
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(GLuint), indices, GL_STATIC_DRAW);
+
+	if (compact)
+	{
+		// Position attributes: normalized 16-bit, decoded by the instance matrix
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactVertex), (GLvoid*)0);
+		glEnableVertexAttribArray(0);
+		// Color attributes: normalized RGBA8
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CompactVertex), (GLvoid*)(4 * sizeof(GLushort)));
+		glEnableVertexAttribArray(1);
+	}
+	else
+	{
+		// Position attributes
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(GLfloat), (GLvoid*)0);
+		glEnableVertexAttribArray(0);
+		// Color attributes
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(1);
+	}
+
+	// Model matrix attributes: one mat4 per instance, advanced once per instance; pointed at the stream in draw()
+	for (GLuint column = 0; column < 4; column++)
+	{
+		glEnableVertexAttribArray(instanceModelLocation + column);
+		glVertexAttribDivisor(instanceModelLocation + column, 1);
+	}
+
+	// Unbind VAO
+	glBindVertexArray(0);
+
+	// Room for 4096 matrices per frame to start with; the ring grows when a frame needs more
+	stream.create(4096 * sizeof(glm::mat4));
+
+	// Commands select their matrices by baseInstance, which is ignored without ARB_base_instance
+	indirectDraws = GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance;
+}
+
+// Point the four model matrix columns at the given instance of a matrix buffer
+void ScenePool::pointInstanceAttributes(GLuint buffer, GLuint firstInstance)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	pointedBuffer = buffer;
+	for (GLuint column = 0; column < 4; column++)
+	{
+		GLsizeiptr offset = firstInstance * sizeof(glm::mat4) + column * sizeof(glm::vec4);
+		glVertexAttribPointer(instanceModelLocation + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (GLvoid*)offset);
+	}
+}
+
+void ScenePool::uploadInstances(const glm::mat4* transforms, size_t count)
+{
+	stream.beginFrame();
+
+	// Matrix-aligned, so the offset becomes a whole number of instances added to baseInstance
+	GLsizeiptr bytes = count * sizeof(glm::mat4);
+	StreamAllocation allocation = stream.allocate(bytes, sizeof(glm::mat4));
+	memcpy(allocation.pointer, transforms, bytes);
+	stream.flush();
+	instanceBuffer = allocation.buffer;
+	instanceBase = (GLuint)(allocation.offset / sizeof(glm::mat4));
+}
+
+void ScenePool::setMeshState(int id, GLuint material, bool transparent)
+{
+	meshes[id].material = material;
+	meshes[id].transparent = transparent;
+}
+
+void ScenePool::setMeshOccluder(int id, bool occluder)
+{
+	meshes[id].occluder = occluder;
+}
+
+AABB ScenePool::storedBounds(int id) const
+{
+	if (!compact)
+	{
+		return meshes[id].bounds;
+	}
+
+	// Compact positions are normalized to the mesh's bounding box
+	AABB unit;
+	unit.min = glm::vec3(0.0f);
+	unit.max = glm::vec3(1.0f);
+	return unit;
+}
+
+// Blending and depth writes for a render pass
+static void setPassState(RenderPass pass)
+{
+	if (pass == TransparentPass)
+	{
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDepthMask(GL_FALSE);
+	}
+	else
+	{
+		glDisable(GL_BLEND);
+		glDepthMask(GL_TRUE);
+	}
+}
+
+// Submit every batch: one VAO bind and, with indirect draws, one multi-draw call per pass
+void ScenePool::draw(RenderState& state, const DrawBatch* batches, size_t batchCount)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	state.bindVertexArray(VAO);
+	frameStats.drawCalls = 0;
+	frameStats.instancesDrawn = 0;
+
+	if (GLEW_ARB_base_instance && pointedBuffer != instanceBuffer)
+	{
+		// The ring moved to a larger buffer; baseInstance covers the per-frame offset otherwise
+		pointInstanceAttributes(instanceBuffer, 0);
+	}
+
+	if (indirectDraws)
+	{
+		// One command per batch, written straight into the stream; baseInstance selects its matrices
+		StreamAllocation allocation = stream.allocate(batchCount * sizeof(DrawElementsIndirectCommand), sizeof(GLuint));
+		DrawElementsIndirectCommand* commands = (DrawElementsIndirectCommand*)allocation.pointer;
+		for (size_t i = 0; i < batchCount; i++)
+		{
+			const MeshRange& range = meshes[batches[i].mesh];
+			commands[i].count = range.indexCount;
+			commands[i].instanceCount = batches[i].instanceCount;
+			commands[i].firstIndex = range.firstIndex;
+			commands[i].baseVertex = range.baseVertex;
+			commands[i].baseInstance = instanceBase + batches[i].firstInstance;
+			frameStats.instancesDrawn += batches[i].instanceCount;
+		}
+		stream.flush();
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, allocation.buffer);
+		drawPasses(batches, batchCount, allocation.offset);
+	}
+	else
+	{
+		// One instanced draw per batch
+		RenderPass pass = OpaquePass;
+		for (size_t i = 0; i < batchCount; i++)
+		{
+			const DrawBatch& batch = batches[i];
+			if (keyPass(batch.key) != pass)
+			{
+				pass = keyPass(batch.key);
+				setPassState(pass);
+			}
+			const MeshRange& range = meshes[batch.mesh];
+			const GLvoid* firstIndex = (const GLvoid*)(range.firstIndex * sizeof(GLuint));
+			if (GLEW_ARB_base_instance)
+			{
+				glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT, firstIndex, batch.instanceCount, range.baseVertex, instanceBase + batch.firstInstance);
+			}
+			else
+			{
+				// GL 3.3: move the attribute pointers instead of using baseInstance
+				pointInstanceAttributes(instanceBuffer, instanceBase + batch.firstInstance);
+				glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT, firstIndex, batch.instanceCount, range.baseVertex);
+			}
+			frameStats.drawCalls++;
+			frameStats.instancesDrawn += batch.instanceCount;
+		}
+		if (pass != OpaquePass)
+		{
+			setPassState(OpaquePass);
+		}
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	state.countIssued(frameStats.drawCalls);
+	frameStats.submitMs = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void ScenePool::drawIndirect(RenderState& state, const DrawBatch* batches, size_t batchCount, GLuint commandBuffer, GLuint instances)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	state.bindVertexArray(VAO);
+	frameStats.drawCalls = 0;
+	frameStats.instancesDrawn = 0;
+	if (pointedBuffer != instances)
+	{
+		pointInstanceAttributes(instances, 0);
+	}
+
+	// Instance counts are only known on the GPU; count what was submitted to it
+	for (size_t i = 0; i < batchCount; i++)
+	{
+		frameStats.instancesDrawn += batches[i].instanceCount;
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	drawPasses(batches, batchCount, 0);
+
+	auto end = std::chrono::high_resolution_clock::now();
+	state.countIssued(frameStats.drawCalls);
+	frameStats.submitMs = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// One glMultiDrawElementsIndirect call per render pass over the bound indirect buffer, one command per batch
+void ScenePool::drawPasses(const DrawBatch* batches, size_t batchCount, GLintptr commandOffset)
+{
+	// Batches arrive sorted, so each pass is one contiguous run of commands
+	for (size_t first = 0; first < batchCount;)
+	{
+		RenderPass pass = keyPass(batches[first].key);
+		size_t last = first + 1;
+		while (last < batchCount && keyPass(batches[last].key) == pass)
+		{
+			last++;
+		}
+		if (pass != OpaquePass)
+		{
+			setPassState(pass);
+		}
+		GLintptr offset = commandOffset + first * sizeof(DrawElementsIndirectCommand);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (GLvoid*)offset, (GLsizei)(last - first), 0);
+		frameStats.drawCalls++;
+		first = last;
+	}
+	if (batchCount > 0 && keyPass(batches[batchCount - 1].key) != OpaquePass)
+	{
+		setPassState(OpaquePass);
+	}
+}
+
+// Delete Vertex Array Object and buffers
+void ScenePool::destroy()
+{
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	stream.destroy();
+	VAO = VBO = EBO = 0;
+	instanceBuffer = pointedBuffer = 0;
+}
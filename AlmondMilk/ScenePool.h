@@ -0,0 +1,125 @@
+#pragma once
+#include <vector>
+#include <GL/glew.h>        // GLEW library
+
+// GLM Libraries
+#include <glm/glm.hpp> 
+
+#include "CompactVertex.h"
+#include "Culling.h"
+#include "DrawSort.h"
+#include "MeshBuilder.h"
+#include "Primitives.h"
+#include "RecordPool.h"
+#include "RenderState.h"
+#include "SceneFile.h"
+#include "StreamBuffer.h"
+
+// First vertex attribute location of the per-instance model matrix (a mat4 takes four locations)
+const GLuint instanceModelLocation = 2;
+
+// Location of one mesh inside the shared vertex and index buffers
+struct MeshRange
+{
+	GLint baseVertex;		// First vertex of the mesh, added to every index
+	GLsizei vertexCount;	// Number of unique vertices in the mesh
+	GLsizei firstIndex;		// First index of the mesh inside the index buffer
+	GLsizei indexCount;		// Number of indices in the mesh
+	glm::mat4 decode;		// Maps stored positions to model space (bounding box transform for compact vertices)
+	AABB bounds;			// Model-space bounding box
+	GLuint program = 0;		// Sort key program; 0 is the scene program bound by the caller
+	GLuint material = 0;	// Sort key material
+	bool transparent = false;	// Drawn in the transparent pass, back to front with blending
+	bool occluder = false;		// Drawn into the depth-only pass of occlusion culling
+};
+
+// Instances of one mesh stored contiguously in the per-frame transform buffer
+struct DrawBatch
+{
+	int mesh;
+	GLuint firstInstance;
+	GLsizei instanceCount;
+	DrawKey key;			// Sort key shared by every instance of the batch
+};
+
+// Layout of one glMultiDrawElementsIndirect command
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// Draw call statistics for the last submitted frame
+struct PoolStats
+{
+	unsigned int drawCalls = 0;			// Number of glDraw* calls issued
+	unsigned int instancesDrawn = 0;	// Number of objects submitted by those calls
+	double submitMs = 0.0;				// CPU time spent submitting, in milliseconds
+};
+
+// Scene geometry pool: packs every mesh into one VBO/EBO/VAO and draws per-object transforms from an instance buffer
+class ScenePool
+{
+public:
+	// compactVertices selects 12-byte quantized vertices instead of 6 floats per vertex
+	explicit ScenePool(bool compactVertices = false) : compact(compactVertices) {}
+
+	// Append indexed mesh; returns mesh id
+	int addMesh(const IndexedMesh& mesh);
+
+	void upload();					// Create VAO/VBO/EBO and copy all meshes to the GPU
+
+	// Write the meshes added so far and the given objects as a scene file; call before upload()
+	bool save(const std::string& path, const std::vector<SceneFileObject>& objects) const;
+
+	// Take the mesh table from a mapped scene file and upload its blobs straight from the mapping.
+	// Replaces addMesh() and upload(); the pool's vertex layout must match the file's.
+	bool uploadFromFile(const SceneFile& file);
+
+	// Start a new frame of the streaming ring and write one model matrix per instance into it in a single copy
+	void uploadInstances(const glm::mat4* transforms, size_t count);
+
+	// Draw every batch in order; one glMultiDrawElementsIndirect call per render pass when the driver supports it
+	void draw(RenderState& state, const DrawBatch* batches, size_t batchCount);
+
+	// Draw the batches with one command each from 'commandBuffer', written on the GPU, and model matrices read
+	// from the start of 'instances'. Needs multi-draw indirect.
+	void drawIndirect(RenderState& state, const DrawBatch* batches, size_t batchCount, GLuint commandBuffer, GLuint instances);
+	void destroy();					// Delete VAO and buffers
+
+	const MeshRange& mesh(int id) const { return meshes[id]; }
+	void setMeshState(int id, GLuint material, bool transparent);		// State used to sort the mesh's draws
+	void setMeshOccluder(int id, bool occluder);						// Large meshes worth drawing depth-only for occlusion culling
+	AABB storedBounds(int id) const;			// Bounds of the vertices as stored, before the decode folded into instance matrices
+	int meshCount() const { return (int)meshes.size(); }
+	GLuint vertexArray() const { return VAO; }
+	const PoolStats& stats() const { return frameStats; }
+	bool compactVertices() const { return compact; }
+	const StreamStats& streamStats() const { return stream.frameStats(); }
+	StreamBuffer& streamBuffer() { return stream; }	// Per-frame ring, also usable for other streamed data after uploadInstances()
+	GLuint instanceStreamBuffer() const { return instanceBuffer; }	// Buffer holding the matrices of the last uploadInstances()
+	GLuint instanceStreamBase() const { return instanceBase; }		// Their first matrix in that buffer
+	GLsizei vertexStride() const { return compact ? sizeof(CompactVertex) : floatsPerVertex * sizeof(GLfloat); }
+
+private:
+	void uploadBuffers(const void* vertices, GLsizeiptr vertexBytes, const GLuint* indices, GLsizeiptr indexCount);
+	void pointInstanceAttributes(GLuint buffer, GLuint firstInstance);
+	void drawPasses(const DrawBatch* batches, size_t batchCount, GLintptr commandOffset);
+
+	bool compact;						// Vertex layout of the pool
+	std::vector<GLubyte> vertexData;	// CPU copy of all vertices, released after upload
+	std::vector<GLuint> indexData;		// CPU copy of all indices, released after upload
+	RecordPool<MeshRange> meshes;		// Mesh table
+	GLsizei totalVertices = 0;
+	GLsizei totalIndices = 0;
+	StreamBuffer stream;				// Instance matrices and indirect commands, rewritten every frame
+	GLuint instanceBuffer = 0;			// Stream buffer holding this frame's matrices
+	GLuint instanceBase = 0;			// Offset of this frame's matrices in the stream buffer, in matrices
+	GLuint pointedBuffer = 0;			// Buffer the VAO's matrix attributes currently read from
+	bool indirectDraws = false;
+	GLuint VAO = 0, VBO = 0, EBO = 0;
+	PoolStats frameStats;
+};
@@ -0,0 +1,270 @@
+#include "ShaderCache.h"
+#include "Shaders.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// FNV-1a over a string, continuing from 'hash'
+static unsigned long long hashString(unsigned long long hash, const string& text)
+{
+	for (unsigned char c : text)
+	{
+		hash = (hash ^ c) * 1099511628211ULL;
+	}
+	return (hash ^ 0xff) * 1099511628211ULL;	// Separator so "ab"+"c" and "a"+"bc" differ
+}
+
+static string glString(GLenum name)
+{
+	const GLubyte* text = glGetString(name);
+	return text ? (const char*)text : "";
+}
+
+// Folder of the running executable with a trailing separator; empty if it cannot be found
+static string executableDirectory()
+{
+	char path[4096];
+#ifdef _WIN32
+	DWORD length = GetModuleFileNameA(NULL, path, sizeof(path));
+	if (length == 0 || length == sizeof(path))
+	{
+		return "";
+	}
+#else
+	ssize_t length = readlink("/proc/self/exe", path, sizeof(path));
+	if (length <= 0 || length == sizeof(path))
+	{
+		return "";
+	}
+#endif
+	string executable(path, length);
+	size_t slash = executable.find_last_of("/\\");
+	return slash == string::npos ? "" : executable.substr(0, slash + 1);
+}
+
+static bool isAbsolute(const string& path)
+{
+	return !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+}
+
+ShaderCache::ShaderCache(const string& directory) : cacheDirectory(isAbsolute(directory) ? directory : executableDirectory() + directory)
+{
+	// A binary only loads on the driver that produced it
+	driver = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+
+	GLint binaryFormats = 0;
+	if (GLEW_ARB_get_program_binary)
+	{
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+	}
+	binarySupport = binaryFormats > 0;
+
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);		// Let the driver pick the thread count
+		parallelSupport = true;
+	}
+	else if (GLEW_ARB_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		parallelSupport = true;
+	}
+
+	if (binarySupport)
+	{
+#ifdef _WIN32
+		_mkdir(cacheDirectory.c_str());
+#else
+		mkdir(cacheDirectory.c_str(), 0755);
+#endif
+	}
+}
+
+string ShaderCache::binaryPath(unsigned long long key) const
+{
+	ostringstream path;
+	path << cacheDirectory << "/" << hex << key << ".bin";
+	return path.str();
+}
+
+int ShaderCache::request(const string& vertexSource, const string& fragmentSource, const string& defines)
+{
+	Entry entry;
+	entry.key = hashString(hashString(hashString(hashString(14695981039346656037ULL, driver), vertexSource), fragmentSource), defines);
+
+	// Same program requested twice shares one entry
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (entries[(int)i].key == entry.key)
+		{
+			return (int)i;
+		}
+	}
+
+	if (!loadBinary(entry))
+	{
+		// Start compiling and linking, but do not query status here: that would wait for the compiler
+		entry.vertexShader = CompileShader(ApplyShaderDefines(vertexSource, defines), GL_VERTEX_SHADER);
+		entry.fragmentShader = CompileShader(ApplyShaderDefines(fragmentSource, defines), GL_FRAGMENT_SHADER);
+		entry.program = glCreateProgram();
+		glAttachShader(entry.program, entry.vertexShader);
+		glAttachShader(entry.program, entry.fragmentShader);
+		if (binarySupport)
+		{
+			glProgramParameteri(entry.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+		glLinkProgram(entry.program);
+		entry.pending = true;
+		counters.compiled++;
+	}
+
+	return entries.add(entry);
+}
+
+bool ShaderCache::ready(int handle) const
+{
+	const Entry& entry = entries[handle];
+	if (!entry.pending || !parallelSupport)
+	{
+		return true;
+	}
+	GLint done = GL_FALSE;
+	glGetProgramiv(entry.program, GL_COMPLETION_STATUS_KHR, &done);
+	return done == GL_TRUE;
+}
+
+GLuint ShaderCache::program(int handle)
+{
+	Entry& entry = entries[handle];
+	if (!entry.pending)
+	{
+		return entry.program;
+	}
+	entry.pending = false;
+
+	bool compiled = CheckShaderCompiled(entry.vertexShader, "Vertex");
+	compiled = CheckShaderCompiled(entry.fragmentShader, "Fragment") && compiled;
+	bool linked = compiled && CheckProgramLinked(entry.program);
+
+	glDetachShader(entry.program, entry.vertexShader);
+	glDetachShader(entry.program, entry.fragmentShader);
+	glDeleteShader(entry.vertexShader);
+	glDeleteShader(entry.fragmentShader);
+	entry.vertexShader = entry.fragmentShader = 0;
+
+	if (!linked)
+	{
+		glDeleteProgram(entry.program);
+		entry.program = 0;
+		counters.failed++;
+		return 0;
+	}
+	saveBinary(entry);
+	return entry.program;
+}
+
+bool ShaderCache::loadBinary(Entry& entry)
+{
+	if (!binarySupport)
+	{
+		return false;
+	}
+	ifstream file(binaryPath(entry.key), ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	GLenum format = 0;
+	if (!file.read(reinterpret_cast<char*>(&format), sizeof(format)))
+	{
+		return false;
+	}
+	vector<char> binary((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	if (binary.empty())
+	{
+		return false;
+	}
+
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, format, binary.data(), (GLsizei)binary.size());
+	GLint status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		// Driver no longer accepts this binary; drop it and compile from source
+		glDeleteProgram(program);
+		remove(binaryPath(entry.key).c_str());
+		counters.binaryRejected++;
+		return false;
+	}
+
+	entry.program = program;
+	entry.fromBinary = true;
+	counters.binaryHits++;
+	return true;
+}
+
+void ShaderCache::saveBinary(const Entry& entry)
+{
+	if (!binarySupport)
+	{
+		return;
+	}
+	GLint length = 0;
+	glGetProgramiv(entry.program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(entry.program, length, nullptr, &format, binary.data());
+
+	ofstream file(binaryPath(entry.key), ios::binary | ios::trunc);
+	if (!file)
+	{
+		cout << "Shader cache: could not write " << binaryPath(entry.key) << endl;
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+	file.write(binary.data(), binary.size());
+}
+
+void ShaderCache::destroy()
+{
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		Entry& entry = entries[(int)i];
+		if (entry.pending)
+		{
+			glDeleteShader(entry.vertexShader);
+			glDeleteShader(entry.fragmentShader);
+		}
+		glDeleteProgram(entry.program);
+	}
+	entries.clear();
+}
+
+void ShaderCache::eraseBinaries()
+{
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		remove(binaryPath(entries[(int)i].key).c_str());
+	}
+}
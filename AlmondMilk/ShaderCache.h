@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <GL/glew.h>        // GLEW library
+
+#include "RecordPool.h"
+
+// Counters for the startup report
+struct ShaderCacheStats
+{
+	int binaryHits = 0;			// Programs loaded from a stored binary
+	int compiled = 0;			// Programs compiled from source
+	int binaryRejected = 0;		// Stored binaries the driver refused (new driver or GPU); recompiled
+	int failed = 0;				// Programs that did not compile or link
+};
+
+// Shader programs keyed by a hash of their source and defines. Linked binaries are written to 'directory'
+// with glGetProgramBinary, so later runs load them with glProgramBinary instead of compiling. A relative
+// directory is taken from the executable's folder, not the working directory.
+// Programs that do need compiling are started in request() and only waited for in program(); with
+// GL_KHR_parallel_shader_compile the driver compiles them on its own threads in the meantime.
+class ShaderCache
+{
+public:
+	explicit ShaderCache(const std::string& directory = "shadercache");
+	~ShaderCache() { destroy(); }
+
+	int request(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines = "");	// Returns handle
+	bool ready(int handle) const;	// True when program() will not wait for the compiler
+	GLuint program(int handle);		// Finish linking if needed; 0 if the program failed
+	bool fromBinary(int handle) const { return entries[handle].fromBinary; }
+	void destroy();					// Delete every program
+	void eraseBinaries();			// Remove the stored binaries of every requested program
+
+	const ShaderCacheStats& stats() const { return counters; }
+	bool binariesSupported() const { return binarySupport; }
+	bool parallelCompile() const { return parallelSupport; }
+
+private:
+	struct Entry
+	{
+		unsigned long long key;
+		GLuint program = 0;
+		GLuint vertexShader = 0;
+		GLuint fragmentShader = 0;
+		bool pending = false;		// Compiling or linking; status not checked yet
+		bool fromBinary = false;
+	};
+
+	std::string binaryPath(unsigned long long key) const;
+	bool loadBinary(Entry& entry);
+	void saveBinary(const Entry& entry);
+
+	std::string cacheDirectory;
+	std::string driver;				// Vendor, renderer and version; part of every key
+	RecordPool<Entry> entries;
+	bool binarySupport = false;
+	bool parallelSupport = false;
+	ShaderCacheStats counters;
+};
@@ -0,0 +1,162 @@
+#include "Shaders.h"
+#include "RenderCamera.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// Vertex shader source code
+const string vertexShaderSource =
+	"#version 330 core\n"						// Version of OpenGL
+	"layout(location = 0) in vec4 vPosition;"	// Specify location of position attributes
+	"layout(location = 1) in vec4 aColor;"		// Specify location of color attributes
+	"layout(location = 2) in mat4 instanceModel;"	// Per-object model matrix (locations 2-5)
+	"out vec4 oColor;"
+	"layout(std140) uniform Camera"				// Shared by every program; see CameraBlock
+	"{"
+	"mat4 view;"
+	"mat4 projection;"
+	"mat4 viewProjection;"
+	"};"
+	"void main()\n" // Entry point for shader
+	"{\n"
+	"gl_Position = viewProjection * instanceModel * vec4(vPosition.xyz, 1.0);"		// Output position coordinates
+	"oColor = aColor;"
+	"}\n";
+
+// Fragment shader source code
+const string fragmentShaderSource =
+	"#version 330 core\n"						// Version of OpenGL
+	"in vec4 oColor;"
+	"out vec4 fragColor;"
+	"void main()\n"
+	"{\n"
+	"fragColor = oColor;"						// Specify colors
+	"}\n";
+
+string ApplyShaderDefines(const string& source, const string& defines)
+{
+	if (defines.empty())
+	{
+		return source;
+	}
+
+	// #version must stay the first line
+	size_t lineEnd = source.find('\n');
+	if (source.compare(0, 8, "#version") != 0 || lineEnd == string::npos)
+	{
+		return defines + "\n" + source;
+	}
+	return source.substr(0, lineEnd + 1) + defines + "\n" + source.substr(lineEnd + 1);
+}
+
+// Create and compile shaders
+GLuint CompileShader(const string& source, GLuint shaderType)
+{
+	GLuint shaderID = glCreateShader(shaderType);	// Create shader object
+	const char* src = source.c_str();
+
+	glShaderSource(shaderID, 1, &src, nullptr);		// Attach source code to shader object
+	glCompileShader(shaderID);						// Compile shader
+	return shaderID;								// Return shader ID
+
+}
+
+bool CheckShaderCompiled(GLuint shader, const char* stage)
+{
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status == GL_TRUE)
+	{
+		return true;
+	}
+
+	GLint logLength = 0;
+	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+	vector<char> log(logLength > 1 ? logLength : 1, '\0');
+	glGetShaderInfoLog(shader, (GLsizei)log.size(), nullptr, log.data());
+	cout << stage << " shader failed to compile:" << endl << log.data() << endl;
+	return false;
+}
+
+bool CheckProgramLinked(GLuint program)
+{
+	GLint status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status == GL_TRUE)
+	{
+		return true;
+	}
+
+	GLint logLength = 0;
+	glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+	vector<char> log(logLength > 1 ? logLength : 1, '\0');
+	glGetProgramInfoLog(program, (GLsizei)log.size(), nullptr, log.data());
+	cout << "Shader program failed to link:" << endl << log.data() << endl;
+	return false;
+}
+
+// Create program object to link shader objects 
+GLuint CreateShaderProgram(const string& vertexShader, const string& fragmentShader)
+{
+	// Compile vertex shader
+	GLuint vertexShaderComp = CompileShader(vertexShader, GL_VERTEX_SHADER);
+
+	// Compile fragment shader
+	GLuint fragmentShaderComp = CompileShader(fragmentShader, GL_FRAGMENT_SHADER);
+	GLuint shaderProgram = glCreateProgram();	// Create program object
+
+	// Attach compiled vertex and fragment shaders to program object
+	glAttachShader(shaderProgram, vertexShaderComp);
+	glAttachShader(shaderProgram, fragmentShaderComp);
+
+	// Link shaders to create final executable shader program
+	glLinkProgram(shaderProgram);
+
+	// Compile errors show up in the shader logs, link errors in the program log
+	bool compiled = CheckShaderCompiled(vertexShaderComp, "Vertex");
+	compiled = CheckShaderCompiled(fragmentShaderComp, "Fragment") && compiled;
+	bool linked = compiled && CheckProgramLinked(shaderProgram);
+
+	// Delete vertex and fragment shaders
+	glDetachShader(shaderProgram, vertexShaderComp);
+	glDetachShader(shaderProgram, fragmentShaderComp);
+	glDeleteShader(vertexShaderComp);
+	glDeleteShader(fragmentShaderComp);
+	if (!linked)
+	{
+		glDeleteProgram(shaderProgram);
+		return 0;
+	}
+	return shaderProgram;	// Return shader Program
+
+}
+
+GLuint CreateComputeProgram(const string& computeShader)
+{
+	GLuint computeShaderComp = CompileShader(computeShader, GL_COMPUTE_SHADER);
+	GLuint program = glCreateProgram();
+	glAttachShader(program, computeShaderComp);
+	glLinkProgram(program);
+
+	bool linked = CheckShaderCompiled(computeShaderComp, "Compute") && CheckProgramLinked(program);
+	glDetachShader(program, computeShaderComp);
+	glDeleteShader(computeShaderComp);
+	if (!linked)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+// Every program reads the camera from the one shared uniform buffer
+void BindCameraBlock(GLuint program)
+{
+	GLuint cameraBlock = glGetUniformBlockIndex(program, "Camera");
+	if (cameraBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(program, cameraBlock, cameraBlockBinding);
+	}
+}
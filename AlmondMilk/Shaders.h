@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <GL/glew.h>        // GLEW library
+
+// Vertex and fragment shader source code for the scene
+extern const std::string vertexShaderSource;
+extern const std::string fragmentShaderSource;
+
+// Bind the Camera uniform block of a linked program, if it has one, to the shared camera buffer
+void BindCameraBlock(GLuint program);
+
+// Insert preprocessor defines (one "#define NAME VALUE" per line) right after the #version line
+std::string ApplyShaderDefines(const std::string& source, const std::string& defines);
+
+// Compile one shader stage without waiting for the result
+GLuint CompileShader(const std::string& source, GLuint shaderType);
+
+// Check compile or link status; on failure print the info log and return false
+bool CheckShaderCompiled(GLuint shader, const char* stage);
+bool CheckProgramLinked(GLuint program);
+
+// Compile vertex and fragment shaders and link them into a program object.
+// Returns 0 and prints the compiler log if either stage fails to compile or the program fails to link.
+GLuint CreateShaderProgram(const std::string& vertexShader, const std::string& fragmentShader);
+
+// Compile a compute shader and link it into a program object (OpenGL 4.3). Returns 0 and prints the log on failure.
+GLuint CreateComputeProgram(const std::string& computeShader);
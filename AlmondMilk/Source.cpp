@@ -7,77 +7,295 @@
 #include <glm/gtc/matrix_transform.hpp> 
 #include <glm/gtc/type_ptr.hpp> 
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "Benchmark.h"
+#include "Camera.h"
+#include "DemoScene.h"
+#include "DynamicResolution.h"
+#include "FixedTimestep.h"
+#include "FramePacing.h"
+#include "FramePipeline.h"
+#include "Headless.h"
+#include "InputRecording.h"
+#include "OcclusionCulling.h"
+#include "Profiler.h"
+#include "RenderCamera.h"
+#include "RenderState.h"
+#include "Scene.h"
+#include "SceneConverter.h"
+#include "SceneFile.h"
+#include "ScenePool.h"
+#include "ShaderCache.h"
+#include "Shaders.h"
+
 using namespace std;
 
 int width, height;			// window variables
-bool perspective = true;	// boolean to change between perspective and orthographic
 
 // Input fucntions 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void cursor_position_callback(GLFWwindow* window, double xpos, double ypos);
+void window_refresh_callback(GLFWwindow* window);
 void processInput(GLFWwindow* window);
 
-void initCamera();			// Function to reset camera
-glm::mat4 viewMatrix = glm::mat4(1.0f);		// Delcare View matrix
-GLfloat fov = 45.0f;		// Declare and nitialize field of view
-
-// Define camera attributes
-glm::vec3 cameraPosition = glm::vec3(0.0f, -3.0f, 10.0f);
-glm::vec3 target = glm::vec3(0.0f, 0.0f, 0.0f);
-glm::vec3 cameraDirection = glm::normalize(cameraPosition - target);
-glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
-glm::vec3 cameraRight = glm::normalize(glm::cross(worldUp, cameraDirection));
-glm::vec3 cameraUp = glm::normalize(glm::cross(cameraDirection, cameraRight));
-glm::vec3 cameraFront = glm::normalize(glm::vec3(0.0f, 0.0f, -1.0f));
-
-// Pitch, yaw, 
-GLfloat yaw = -90.0f, pitch = 0.0f;
-// Variables for scroll and cursor
-GLfloat cameraMovement = 10.0f;
-GLfloat cameraSpeed = 2.5f;
+const double idleWaitSeconds = 0.1;		// Longest sleep between input checks while nothing needs redrawing
+bool redrawRequested = false;			// Window contents were damaged and must be drawn again
+
+// Variables for cursor
 GLfloat delataTime = 0.0f, lastFrame = 0.0f; // Variables to ensure application runs the same on all hardware
 GLfloat lastX = 320, lastY = 240, xChange, yChange;
 bool firstMouseMove = true; // Detect initial mouse movement
+bool depthKeyDown = false;	// 'Z' held last frame, so holding it switches the depth convention once
+CameraInput pendingInput;	// Keys, cursor and scroll gathered for the next simulation tick
 
 
-// Create and compile shaders
-static GLuint CompileShader(const string& source, GLuint shaderType)
+int main(int argc, char* argv[])
 {
-	GLuint shaderID = glCreateShader(shaderType);	// Create shader object
-	const char* src = source.c_str();
+	// Run headless pool benchmark instead of the interactive scene: --bench-pool [copies] [frames]
+	if (argc > 1 && strcmp(argv[1], "--bench-pool") == 0)
+	{
+		int copies = argc > 2 ? atoi(argv[2]) : 250;
+		int frames = argc > 3 ? atoi(argv[3]) : 200;
+		return runPoolBenchmark(copies, frames);
+	}
 
-	glShaderSource(shaderID, 1, &src, nullptr);		// Attach source code to shader object
-	glCompileShader(shaderID);						// Compile shader
-	return shaderID;								// Return shader ID
+	// Check reconstruction error and size of the quantized vertex layout: --test-compact-vertices
+	if (argc > 1 && strcmp(argv[1], "--test-compact-vertices") == 0)
+	{
+		return runCompactVertexTest();
+	}
 
-}
+	// Run headless culling benchmark: --bench-cull [objects] [frames] [recording]
+	if (argc > 1 && strcmp(argv[1], "--bench-cull") == 0)
+	{
+		int objects = argc > 2 ? atoi(argv[2]) : 100000;
+		int frames = argc > 3 ? atoi(argv[3]) : 600;
+		const char* recording = argc > 4 ? argv[4] : nullptr;
+		return runCullBenchmark(objects, frames, recording);
+	}
 
-// Create program object to link shader objects 
-static GLuint CreateShaderProgram(const string& vertexShader, const string& fragmentShader)
-{
-	// Compile vertex shader
-	GLuint vertexShaderComp = CompileShader(vertexShader, GL_VERTEX_SHADER);
+	// Run transform kernel benchmark: --bench-transform [objects] [iterations]
+	if (argc > 1 && strcmp(argv[1], "--bench-transform") == 0)
+	{
+		int objects = argc > 2 ? atoi(argv[2]) : 100000;
+		int iterations = argc > 3 ? atoi(argv[3]) : 200;
+		return runTransformBenchmark(objects, iterations);
+	}
 
-	// Compile fragment shader
-	GLuint fragmentShaderComp = CompileShader(fragmentShader, GL_FRAGMENT_SHADER);
-	GLuint shaderProgram = glCreateProgram();	// Create program object
+	// Compare depth fighting of standard and reverse-Z depth at large distances: --test-depth
+	if (argc > 1 && strcmp(argv[1], "--test-depth") == 0)
+	{
+		return runDepthPrecisionTest();
+	}
 
-	// Attach compiled vertex and fragment shaders to program object
-	glAttachShader(shaderProgram, vertexShaderComp);
-	glAttachShader(shaderProgram, fragmentShaderComp);
+	// Check GPU occlusion culling hides objects behind a wall without changing the image: --test-occlusion [objects] [frames]
+	if (argc > 1 && strcmp(argv[1], "--test-occlusion") == 0)
+	{
+		int objects = argc > 2 ? atoi(argv[2]) : 2000;
+		int frames = argc > 3 ? atoi(argv[3]) : 20;
+		return runOcclusionTest(objects, frames);
+	}
 
-	// Link shaders to create final executable shader program
-	glLinkProgram(shaderProgram);
+	// Check the frame limiter, adaptive vsync and latency histogram: --test-pacing [frames]
+	if (argc > 1 && strcmp(argv[1], "--test-pacing") == 0)
+	{
+		int frames = argc > 2 ? atoi(argv[2]) : 240;
+		return runFramePacingTest(frames);
+	}
 
-	// Delete vertex and fragment shaders
-	glDeleteShader(vertexShaderComp);
-	glDeleteShader(fragmentShaderComp);
-	return shaderProgram;	// Return shader Program
+	// Check dynamic resolution settles under synthetic load: --test-resolution [frames]
+	if (argc > 1 && strcmp(argv[1], "--test-resolution") == 0)
+	{
+		int frames = argc > 2 ? atoi(argv[2]) : 600;
+		return runDynamicResolutionTest(frames);
+	}
 
-}
+	// Check lazy camera matrices and idle redraw skipping: --test-camera
+	if (argc > 1 && strcmp(argv[1], "--test-camera") == 0)
+	{
+		return runCameraTest();
+	}
+
+	// Check the render loop stops allocating: --test-allocations [objects] [frames]
+	if (argc > 1 && strcmp(argv[1], "--test-allocations") == 0)
+	{
+		int objects = argc > 2 ? atoi(argv[2]) : 100000;
+		int frames = argc > 3 ? atoi(argv[3]) : 240;
+		return runAllocationTest(objects, frames);
+	}
+
+	// Run headless draw sorting benchmark: --bench-sort [objects] [frames]
+	if (argc > 1 && strcmp(argv[1], "--bench-sort") == 0)
+	{
+		int objects = argc > 2 ? atoi(argv[2]) : 200000;
+		int frames = argc > 3 ? atoi(argv[3]) : 120;
+		return runDrawSortBenchmark(objects, frames);
+	}
+
+	// Run headless multithreaded draw list benchmark: --bench-threads [objects] [frames]
+	if (argc > 1 && strcmp(argv[1], "--bench-threads") == 0)
+	{
+		int objects = argc > 2 ? atoi(argv[2]) : 400000;
+		int frames = argc > 3 ? atoi(argv[3]) : 120;
+		return runThreadScalingBenchmark(objects, frames);
+	}
+
+	// Check fixed-timestep camera input and interpolation at several frame rates: --test-timestep [seconds]
+	if (argc > 1 && strcmp(argv[1], "--test-timestep") == 0)
+	{
+		double seconds = argc > 2 ? atof(argv[2]) : 30.0;
+		return runTimestepReplayTest(seconds);
+	}
+
+	// Check procedural mesh counts, watertightness and LOD selection: --test-meshes [shapes]
+	if (argc > 1 && strcmp(argv[1], "--test-meshes") == 0)
+	{
+		int shapes = argc > 2 ? atoi(argv[2]) : 2000;
+		return runMeshGeneratorTest(shapes);
+	}
+
+	// Run headless frame-time benchmark: --bench-frames [frames] [donut boxes] [json file]
+	if (argc > 1 && strcmp(argv[1], "--bench-frames") == 0)
+	{
+		int frames = argc > 2 ? atoi(argv[2]) : 600;
+		int donutBoxes = argc > 3 ? atoi(argv[3]) : 1000;
+		const char* jsonPath = argc > 4 ? argv[4] : nullptr;
+		return runFrameBenchmark(frames, donutBoxes, jsonPath);
+	}
+
+	// Measure cold and warm shader program startup: --bench-shaders [programs]
+	if (argc > 1 && strcmp(argv[1], "--bench-shaders") == 0)
+	{
+		int programs = argc > 2 ? atoi(argv[2]) : 20;
+		return runShaderBenchmark(programs);
+	}
+
+	// Write a binary scene file from the built-in primitives or OBJ files: --convert-scene out.amsc [--compact-vertices] [file.obj ...]
+	if (argc > 2 && strcmp(argv[1], "--convert-scene") == 0)
+	{
+		vector<string> objPaths;
+		bool compact = false;
+		for (int i = 3; i < argc; i++)
+		{
+			if (strcmp(argv[i], "--compact-vertices") == 0)
+			{
+				compact = true;
+			}
+			else
+			{
+				objPaths.push_back(argv[i]);
+			}
+		}
+		return convertScene(argv[2], objPaths, compact);
+	}
+
+	// Compare OBJ text loading with the mapped scene file: --bench-scene-load [file.obj] [iterations]
+	if (argc > 1 && strcmp(argv[1], "--bench-scene-load") == 0)
+	{
+		const char* objPath = argc > 2 ? argv[2] : nullptr;
+		int iterations = argc > 3 ? atoi(argv[3]) : 5;
+		return runSceneLoadBenchmark(objPath, iterations);
+	}
+
+	// Replay a recorded input file headless: --replay file
+	if (argc > 2 && strcmp(argv[1], "--replay") == 0)
+	{
+		return runInputReplay(argv[2]);
+	}
+
+	// Optional 12-byte quantized vertex layout: --compact-vertices
+	// Extra instanced copies of the donut box behind the scene: --donut-boxes N
+	// Record camera input of this session for later replay: --record file
+	// Record CPU/GPU timer scopes and write them as a Chrome trace on exit: --profile-trace file
+	// Draw a binary scene file instead of the built-in scene: --scene file.amsc
+	// Build draw lists on N threads, including the main thread (all cores by default): --threads N
+	// Build and submit each frame's draw list in the same frame, without the extra frame of latency: --no-pipeline
+	// Start in reverse-Z depth with an infinite far plane (toggle with 'Z'): --reverse-z
+	// Skip objects hidden behind large occluders with a Hi-Z test on the GPU: --occlusion
+	// Cap the frame rate (0 leaves it to vsync): --fps N
+	// Swap interval control, adaptive by default: --vsync off|on|adaptive
+	// Scale the render resolution to keep the scene's GPU time within budget: --dynamic-resolution
+	// GPU time budget for dynamic resolution (one frame at the target or refresh rate by default): --resolution-budget ms
+	bool compactVertices = false;
+	const char* scenePath = nullptr;
+	int extraDonutBoxes = 0;
+	const char* recordingPath = nullptr;
+	const char* tracePath = nullptr;
+	unsigned int jobThreads = 0;
+	bool pipelineFrames = true;
+	bool occlusionCulling = false;
+	double targetFps = 0.0;
+	VsyncMode vsync = VsyncAdaptive;
+	bool dynamicResolution = false;
+	double resolutionBudgetMs = 0.0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--compact-vertices") == 0)
+		{
+			compactVertices = true;
+		}
+		else if (strcmp(argv[i], "--donut-boxes") == 0 && i + 1 < argc)
+		{
+			extraDonutBoxes = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			recordingPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+		{
+			scenePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--profile-trace") == 0 && i + 1 < argc)
+		{
+			tracePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			jobThreads = (unsigned int)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--no-pipeline") == 0)
+		{
+			pipelineFrames = false;
+		}
+		else if (strcmp(argv[i], "--reverse-z") == 0)
+		{
+			reverseDepth = true;
+		}
+		else if (strcmp(argv[i], "--occlusion") == 0)
+		{
+			occlusionCulling = true;
+		}
+		else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+		{
+			targetFps = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--vsync") == 0 && i + 1 < argc)
+		{
+			if (!parseVsyncMode(argv[++i], vsync))
+			{
+				cout << "Unknown vsync mode " << argv[i] << "; expected off, on or adaptive" << endl;
+				return -1;
+			}
+		}
+		else if (strcmp(argv[i], "--dynamic-resolution") == 0)
+		{
+			dynamicResolution = true;
+		}
+		else if (strcmp(argv[i], "--resolution-budget") == 0 && i + 1 < argc)
+		{
+			resolutionBudgetMs = atof(argv[++i]);
+		}
+	}
 
-int main(void)
-{
 	width = 640; height = 480;	// Set values for screen dimensions
 	GLFWwindow* window;		// Declare new window object
 
@@ -99,6 +317,7 @@ int main(void)
 
 	glfwSetCursorPosCallback(window, cursor_position_callback);
 	glfwSetScrollCallback(window, scroll_callback);
+	glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 
@@ -113,362 +332,418 @@ int main(void)
 
 	glEnable(GL_DEPTH_TEST);	// Allows for depth comparisons and to update the depth buffer
 
+	// Frame rate cap, swap interval and input-to-present latency
+	FramePacer pacer(targetFps, vsync);
+	pacer.start(window);
+	cout << "Frame pacing: " << (targetFps > 0.0 ? to_string((int)targetFps) + " fps cap" : string("no cap")) << ", vsync " << vsyncModeName(vsync)
+		<< (pacer.tearControl() ? " (driver tear control)" : "") << ", display " << pacer.refreshRate() << " Hz" << endl;
+
+	// Reverse-Z draws into an offscreen target with a float depth buffer, then copies the color to the window
+	if (reverseDepth && !reverseDepthSupported())
+	{
+		cout << "Reverse-Z needs OpenGL 4.5 or ARB_clip_control; using standard depth" << endl;
+		reverseDepth = false;
+	}
+	bool appliedReverseDepth = false;
+
+	// Dynamic resolution renders a scaled rectangle of the same target and stretches it over the window
+	FrameGpuTimer sceneTimer;
+	if (dynamicResolution && !sceneTimer.create())
+	{
+		cout << "Dynamic resolution needs timer queries (OpenGL 3.3 or ARB_timer_query); rendering at full resolution" << endl;
+		dynamicResolution = false;
+	}
+	if (resolutionBudgetMs <= 0.0)
+	{
+		resolutionBudgetMs = 1000.0 / (targetFps > 0.0 ? targetFps : pacer.refreshRate());
+	}
+	ResolutionController resolution(resolutionBudgetMs);
+	if (dynamicResolution)
+	{
+		cout << "Dynamic resolution: " << resolutionBudgetMs << " ms GPU budget for the scene" << endl;
+	}
+	Framebuffer sceneTarget;
+
 	// Wireframe
 	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+
+	// Start the shader program first so the driver can compile it while the meshes are built;
+	// a warm start loads the linked binary from the shader cache instead
+	auto shaderStart = chrono::high_resolution_clock::now();
+	ShaderCache shaderCache;
+	int sceneShader = shaderCache.request(vertexShaderSource, fragmentShaderSource);
+	double shaderMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - shaderStart).count();
 	
-	// Define vertex data for triangles in a floating point array for PLANE
-	GLfloat planeVertices[] = {
-
-		-5.0, -5.0, -5.0,	1.0, 0.0, 0.0,
-		 5.0, -5.0, -5.0,	1.0, 0.0, 0.0,
-		 5.0, -5.0, 5.0,	1.0, 0.0, 0.0,
-		 5.0, -5.0, 5.0,	1.0, 0.0, 0.0,
-		-5.0, -5.0, 5.0,	1.0, 0.0, 0.0,
-		-5.0, -5.0, -5.0,	1.0, 0.0, 0.0
-	};
-
-
-	// Create variables for PLANE reference
-	GLuint VBO1,VAO1;
-
-	// Create new Vertex Buffer Object, Vertex Array Object, and Element Buffer Object
-	glGenVertexArrays(1, &VAO1);
-	glGenBuffers(1, &VBO1);	// (# of buffers, where to store id for buffer when created)
-	glBindVertexArray(VAO1);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO1);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(planeVertices), planeVertices, GL_STATIC_DRAW);
-
-	// Position attributes
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(1);
-
-	// Define vertex data for triangles in a floating point array for Almond Milk base cube
-	GLfloat milkCubeVertices[] = {
-
-		-2.0, -2.0, -2.0,		0.0, 1.0, 0.0,
-		 0.0, -2.0, -2.0,		0.0, 1.0, 0.0,
-		-2.0, -2.0,  0.0,		0.0, 1.0, 0.0,		// Top of Almond Milk cube
-		-2.0, -2.0,  0.0,		0.0, 1.0, 0.0,
-		 0.0, -2.0, -2.0,		0.0, 1.0, 0.0,
-		 0.0, -2.0,  0.0,		0.0, 1.0, 0.0,
-		
-		-2.0, -5.0, -2.0,		0.0, 1.0, 0.0,
-		 0.0, -5.0, -2.0,		0.0, 1.0, 0.0,
-		-2.0, -5.0, 0.0,		0.0, 1.0, 0.0,		// Bottom of Almond Milk cube
-		-2.0, -5.0, 0.0,		0.0, 1.0, 0.0,
-		 0.0, -5.0, -2.0,		0.0, 1.0, 0.0,
-		 0.0, -5.0, 0.0,		0.0, 1.0, 0.0,
-
-		-2.0, -2.0, 0.0,		0.0, 1.0, 0.0,
-		-2.0, -5.0, 0.0,		0.0, 1.0, 0.0,
-		 0.0, -5.0, 0.0,		0.0, 1.0, 0.0,		// Front of Almond Milk cube
-		 0.0, -5.0, 0.0,		0.0, 1.0, 0.0,
-		-2.0, -2.0, 0.0,		0.0, 1.0, 0.0,
-		 0.0, -2.0, 0.0,		0.0, 1.0, 0.0,
-
-		-2.0, -2.0, -2.0,		0.0, 1.0, 0.0,
-		-2.0, -5.0, -2.0,		0.0, 1.0, 0.0,
-		 0.0, -2.0, -2.0,		0.0, 1.0, 0.0,		// Back of Almond Milk cube
-		 0.0, -5.0, -2.0,		0.0, 1.0, 0.0,
-		 0.0, -2.0, -2.0,		0.0, 1.0, 0.0,
-		-2.0, -5.0, -2.0,		0.0, 1.0, 0.0,
-		
-		-2.0, -2.0, -2.0,		0.0, 1.0, 0.0,
-		-2.0, -2.0, 0.0,		0.0, 1.0, 0.0,
-		-2.0, -5.0, 0.0,		0.0, 1.0, 0.0,		// Left side of Almond Milk cube
-		-2.0, -2.0, -2.0,		0.0, 1.0, 0.0,
-		-2.0, -5.0, -2.0,		0.0, 1.0, 0.0,
-		-2.0, -5.0, 0.0,		0.0, 1.0, 0.0,
-
-		 0.0, -2.0,  0.0,		0.0, 1.0, 0.0,
-		 0.0, -5.0, -2.0,		0.0, 1.0, 0.0, 
-		 0.0, -5.0,  0.0,		0.0, 1.0, 0.0,		// Right side of Almond Milk cube
-		 0.0, -2.0,  0.0,		0.0, 1.0, 0.0,
-		 0.0, -2.0, -2.0,		0.0, 1.0, 0.0,
-		 0.0, -5.0, -2.0,		0.0, 1.0, 0.0
-	};
-
-	// Create variables for Almond Milk base cube reference
-	GLuint VBO2, VAO2;
-
-	// Create new Vertex Buffer Object, Vertex Array Object, and Element Buffer Object
-	glGenVertexArrays(1, &VAO2);
-	glGenBuffers(1, &VBO2); // (# of buffers, where to store id for buffer when created)
-	glBindVertexArray(VAO2);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO2);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(milkCubeVertices), milkCubeVertices, GL_STATIC_DRAW);
-
-	// Position attributes
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(1);
-
-	// Define vertex data for triangles in a floating point array for Almond Milk top pyramids
-	GLfloat milkCPyramidVertices[] = {
-
-		-2.0, -2.0, -2.0,		0.0, 0.0, 1.0,
-		-1.0, -2.0,  0.0,		0.0, 0.0, 1.0,
-		-2.0, -2.0,  0.0,		0.0, 0.0, 1.0,		// Bottom of left Almond Milk pyramid NOT SEEEN
-		-2.0, -2.0, -2.0,		0.0, 0.0, 1.0,
-		-1.0, -2.0,  0.0,		0.0, 0.0, 1.0,
-		-1.0, -2.0, -2.0,		0.0, 0.0, 1.0,
-
-		-2.0, -2.0, -2.0,		1.0, 0.0, 0.0,
-		-2.0, -2.0,  0.0,		1.0, 0.0, 0.0,
-		-1.5, -0.5, -1.0,		1.0, 0.0, 0.0,		// Left side of left Almond Milk pyramid RED
-
-		-2.0, -2.0, -2.0,		0.0, 1.0, 1.0,
-		-1.0, -2.0, -2.0,		0.0, 1.0, 1.0,
-		-1.5, -0.5, -1.0,		0.0, 1.0, 1.0,		// Back side of left Almond Milk pyramid CYAN
-
-		-1.0, -2.0, -2.0,		0.0, 0.0, 1.0,
-		-1.0, -2.0,  0.0,		0.0, 0.0, 1.0,
-		-1.5, -0.5, -1.0,		0.0, 0.0, 1.0,		// Right side of left Almond Milk pyramid NOT SEEEN
-
-		-2.0, -2.0, 0.0,		1.0, 0.0, 1.0,
-		-1.0, -2.0,  0.0,		1.0, 0.0, 1.0,
-		-1.5, -0.5, -1.0,		1.0, 0.0, 1.0,		// Front side of left Almond Milk pyramid PURPLE
-
-		-1.0, -2.0, -2.0,		0.0, 1.0, 1.0,
-		-1.0, -2.0,  0.0,		0.0, 1.0, 1.0, 
-		 0.0, -2.0,  0.0,		0.0, 1.0, 1.0,		// Bottom of right Almond Milk pyramid NOT SEEEN
-		-1.0, -2.0, -2.0,		0.0, 1.0, 1.0,
-		 0.0, -2.0,  0.0,		0.0, 1.0, 1.0,
-		 0.0, -2.0, -2.0,		0.0, 1.0, 1.0,
-
-		-1.0, -2.0,  0.0,		0.0, 1.0, 1.0,
-		-1.0, -2.0, -2.0,		0.0, 1.0, 1.0,
-		-0.5, -0.5, -1.0,		0.0, 1.0, 1.0,		// Left side of right Almond Milk pyramid NOT SEEEN
-
-		-1.0, -2.0, -2.0,		0.0, 1.0, 1.0,
-		 0.0, -2.0, -2.0,		0.0, 1.0, 1.0,
-		-0.5, -0.5, -1.0,		0.0, 1.0, 1.0,		// Back side of right Almond Milk pyramid CYAN
-
-		 0.0, -2.0, -2.0,		1.0, 0.0, 0.0,
-		 0.0, -2.0,  0.0,		1.0, 0.0, 0.0,
-		-0.5, -0.5, -1.0,		1.0, 0.0, 0.0,		// Right side of right Almond Milk pyramid RED
-
-		 0.0, -2.0,  0.0,		1.0, 0.0, 1.0,
-		-1.0, -2.0,  0.0,		1.0, 0.0, 1.0,
-		-0.5, -0.5, -1.0,		1.0, 0.0, 1.0,		// Front side of right Almond Milk pyramid PURPLE
-
-		-1.0, -2.0,  0.0,		1.0, 0.0, 1.0,
-		-1.5, -0.5, -1.0,		1.0, 0.0, 1.0,
-		-0.5, -0.5, -1.0,		1.0, 0.0, 1.0,		// Front triangle connecting both pyramids PURPLE
-
-		 -1, -2.0,  -2.0,		0.0, 1.0, 1.0,
-		-1.5, -0.5, -1.0,		0.0, 1.0, 1.0,
-		-0.5, -0.5, -1.0,		0.0, 1.0, 1.0		// Back triangle connecting both pyramids CYAN
-	
-	};
-
-	// Create variables for Almond Milk top reference
-	GLuint VBO3, VAO3;
-
-	// Create new Vertex Buffer Object, Vertex Array Object, and Element Buffer Object
-	glGenVertexArrays(1, &VAO3);
-	glGenBuffers(1, &VBO3); // (# of buffers, where to store id for buffer when created)
-	glBindVertexArray(VAO3);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO3);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(milkCPyramidVertices), milkCPyramidVertices, GL_STATIC_DRAW);
-
-	// Position attributes
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(1);
-
-	// Define vertex data for triangles in a floating point array for Donut box 
-	GLfloat donutBoxVertices[] =
-	{
-		1.0, -5.0, 0.0,		0.5, 0.5, 0.5,
-		2.5, -5.0, -1.5,	0.5, 0.5, 0.5,
-		3.0, -5.0, 2.0,		0.5, 0.5, 0.5,
-		3.0, -5.0, 2.0,		0.5, 0.5, 0.5,		// Bottom of donut box cube
-		4.5, -5.0, 0.5,		0.5, 0.5, 0.5,
-		2.5, -5.0, -1.5,	0.5, 0.5, 0.5,
-
-		1.0, -4.0, 0.0,		0.5, 0.5, 0.5,
-		2.5, -4.0, -1.5,	0.5, 0.5, 0.5,
-		3.0, -4.0, 2.0,		0.5, 0.5, 0.5,
-		3.0, -4.0, 2.0,		0.5, 0.5, 0.5,		// Top of donut box cube
-		4.5, -4.0, 0.5,		0.5, 0.5, 0.5,
-		2.5, -4.0, -1.5,	0.5, 0.5, 0.5,
-
-		1.0, -5.0, 0.0,		0.5, 0.5, 0.5,
-		1.0, -4.0, 0.0,		0.5, 0.5, 0.5,
-		3.0, -5.0, 2.0,		0.5, 0.5, 0.5,		// Front of donut box cube
-		3.0, -5.0, 2.0,		0.5, 0.5, 0.5,
-		1.0, -4.0, 0.0,		0.5, 0.5, 0.5,
-		3.0, -4.0, 2.0,		0.5, 0.5, 0.5,
-
-		3.0, -5.0, 2.0,		0.5, 0.5, 0.5,
-		3.0, -4.0, 2.0,		0.5, 0.5, 0.5,
-		4.5, -5.0, 0.5,		0.5, 0.5, 0.5,		// Right side of donut box cube
-		4.5, -5.0, 0.5,		0.5, 0.5, 0.5,
-		3.0, -4.0, 2.0,		0.5, 0.5, 0.5,
-		4.5, -4.0, 0.5,		0.5, 0.5, 0.5,
-
-		1.0, -5.0, 0.0,		0.5, 0.5, 0.5,
-		1.0, -4.0, 0.0,		0.5, 0.5, 0.5,
-		2.5, -5.0, -1.5,	0.5, 0.5, 0.5,		// Left side of donut box cube
-		2.5, -5.0, -1.5,	0.5, 0.5, 0.5,
-		1.0, -4.0, 0.0,		0.5, 0.5, 0.5,
-		2.5, -4.0, -1.5,	0.5, 0.5, 0.5,
-
-		2.5, -5.0, -1.5,	0.5, 0.5, 0.5,
-		2.5, -4.0, -1.5,	0.5, 0.5, 0.5,
-		4.5, -5.0, 0.5,		0.5, 0.5, 0.5,	// Back side of donut box cube
-		4.5, -5.0, 0.5,		0.5, 0.5, 0.5,
-		2.5, -4.0, -1.5,	0.5, 0.5, 0.5,
-		4.5, -4.0, 0.5,		0.5, 0.5, 0.5
-	};
-
-	// Create variables for Donut box reference
-	GLuint VBO4, VAO4;
-
-	// Create new Vertex Buffer Object, Vertex Array Object, and Element Buffer Object
-	glGenVertexArrays(1, &VAO4);
-	glGenBuffers(1, &VBO4); // (# of buffers, where to store id for buffer when created)
-	glBindVertexArray(VAO4);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO4);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(donutBoxVertices), donutBoxVertices, GL_STATIC_DRAW);
-
-	// Position attributes
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(1);
-
-	// Unbind VOA
-	glBindVertexArray(0);
-
-	// Vertex shader source code
-	string vertexShaderSource =
-		"#version 330 core\n"						// Version of OpenGL
-		"layout(location = 0) in vec4 vPosition;"	// Specify location of position attributes
-		"layout(location = 1) in vec4 aColor;"		// Specify location of color attributes
-		"out vec4 oColor;"
-		"uniform mat4 model;"
-		"uniform mat4 view;"
-		"uniform mat4 projection;"
-		"void main()\n" // Entry point for shader
-		"{\n"
-		"gl_Position = projection * view * model * vPosition;"		// Output position coordinates
-		"oColor = aColor;"
-		"}\n";
-
-	// Fragment shader source code
-	string fragmentShaderSource =
-		"#version 330 core\n"						// Version of OpenGL
-		"in vec4 oColor;"
-		"out vec4 fragColor;"
-		"void main()\n"
-		"{\n"
-		"fragColor = oColor;"						// Specify colors
-		"}\n";
-
-	// Create shader program
-	GLuint shaderProgram = CreateShaderProgram(vertexShaderSource, fragmentShaderSource);
+	// Map the scene file, if one was given, before creating the pool so the pool uses the file's vertex layout
+	SceneFile sceneFile;
+	if (scenePath && !sceneFile.open(scenePath))
+	{
+		shaderCache.destroy();
+		glfwTerminate();
+		return -1;
+	}
+	ScenePool scenePool(scenePath ? sceneFile.compactVertices() : compactVertices);
+	Scene scene;
+
+	if (scenePath)
+	{
+		// Geometry goes to the GPU straight from the mapping; only the object table is read
+		if (!scenePool.uploadFromFile(sceneFile))
+		{
+			sceneFile.close();
+			scenePool.destroy();
+			shaderCache.destroy();
+			glfwTerminate();
+			return -1;
+		}
+		for (GLuint i = 0; i < sceneFile.header().objectCount; i++)
+		{
+			const SceneFileObject& object = sceneFile.objects()[i];
+			scene.addObject((int)object.mesh, glm::make_mat4(object.model));
+		}
+		cout << "Loaded " << scenePath << ": " << scenePool.meshCount() << " meshes, " << scene.objectCount() << " objects" << endl;
+		sceneFile.close();
+	}
+	else
+	{
+		// Pack every primitive into the shared scene geometry pool and place the objects
+		DemoMeshes meshes = addDemoMeshes(scenePool, true);
+		scenePool.upload();
+		populateDemoScene(scene, scenePool, meshes, extraDonutBoxes);
+	}
+	cout << "Transform kernel: " << kernelPathName(detectKernelPath()) << endl;
+
+	// Finish the shader program; only waits if the compiler is still busy
+	shaderStart = chrono::high_resolution_clock::now();
+	GLuint shaderProgram = shaderCache.program(sceneShader);
+	shaderMs += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - shaderStart).count();
+	if (!shaderProgram)
+	{
+		shaderCache.destroy();
+		scenePool.destroy();
+		glfwTerminate();
+		return -1;
+	}
+	cout << "Shader program: " << (shaderCache.fromBinary(sceneShader) ? "loaded from binary cache" : "compiled from source")
+		<< " in " << shaderMs << " ms of startup" << (shaderCache.parallelCompile() ? " (parallel compile)" : "") << endl;
+
+	// Occluders are drawn depth-only each frame and every instance is tested against their Hi-Z pyramid
+	OcclusionCuller occlusion;
+	if (occlusionCulling && !OcclusionCuller::supported())
+	{
+		cout << "Occlusion culling needs OpenGL 4.3; drawing every visible object" << endl;
+		occlusionCulling = false;
+	}
+	if (occlusionCulling && !occlusion.create())
+	{
+		occlusionCulling = false;
+	}
+	if (occlusionCulling && scenePath)
+	{
+		cout << "Occluders: " << markLargeOccluders(scenePool, 0.25f) << " of " << scenePool.meshCount() << " meshes" << endl;
+	}
+
+	// Point the program's Camera block at the shared camera buffer
+	BindCameraBlock(shaderProgram);
+	CameraUniformBuffer cameraBuffer;
+	cameraBuffer.create();
+	RenderCamera camera;
+
+	// Tracks the bound program and VAO so unchanged state is not sent again
+	RenderState renderState;
+	GLfloat lastStatsReport = 0.0f;
+	unsigned long long lastStatsAllocations = heapAllocationCount();
+	int framesSinceStats = 0;
+
+	// Camera runs at a fixed 120 Hz; rendering interpolates between the last two ticks
+	FixedTimestep simulation(simulationStep);
+	CameraState previousCamera = captureCameraState();
+	CameraState currentCamera = previousCamera;
+
+	// Timer scopes only record when a trace was asked for
+	profilerEnabled = tracePath != nullptr;
+	if (!ALMOND_PROFILE && tracePath)
+	{
+		cout << "Profiling was compiled out (ALMOND_PROFILE=0); no trace will be written" << endl;
+	}
+	gpuProfiler.init();
+
+	InputRecorder recorder;
+	if (recordingPath && !recorder.open(recordingPath))
+	{
+		gpuProfiler.destroy();
+		cameraBuffer.destroy();
+		sceneTimer.destroy();
+		occlusion.destroy();
+		shaderCache.destroy();
+		scenePool.destroy();
+		glfwTerminate();
+		return -1;
+	}
+
+	// Worker threads cull and build draw lists; only this thread talks to GL
+	JobSystem jobs(jobThreads);
+	FramePipeline pipeline(jobs, pipelineFrames);
+	cout << "Building draw lists on " << jobs.threadCount() << " threads" << (pipelineFrames ? ", one frame ahead of submission" : "") << endl;
+
+	// Once the camera stops and nothing animates, the last frame stays on screen; one more frame is drawn per
+	// frame in flight first, so the list built from the final camera gets presented
+	RedrawTracker redraw(pipelineFrames ? 2 : 1);
+	double previousInputTime = -1.0;	// When the input of the list built last frame was read
 
 	// Render loop (infinite loop until user closes window)
 	while (!glfwWindowShouldClose(window))
 	{
+		PROFILE_SCOPE("Frame");
+
+		// Wait for this frame's slot, then poll and read input as late as possible before the camera is computed
+		{
+			PROFILE_SCOPE("Pace");
+			pacer.waitForFrame();
+		}
+		gpuProfiler.beginFrame();
+		{
+			PROFILE_SCOPE("Poll events");
+			glfwPollEvents();
+		}
+
 		// Set delta time
 		GLfloat currentFrame = glfwGetTime();
 		delataTime = currentFrame - lastFrame;  // Ensure we are transforming at consistent rate
 		lastFrame = currentFrame;
+		renderState.beginFrame();
+
+		{
+			PROFILE_SCOPE("Input");
+			processInput(window);
+		}
+		double inputTime = pacer.now();
 
-		processInput(window);
+		// Run as many camera ticks as the elapsed time covers; cursor and scroll input goes to the first one
+		int ticks = simulation.advance(delataTime);
+		for (int tick = 0; tick < ticks; tick++)
+		{
+			PROFILE_SCOPE("Camera tick");
+			previousCamera = currentCamera;
+			if (recorder.isOpen())
+			{
+				recorder.record(simulation.ticks() - ticks + tick, pendingInput);
+			}
+			stepCamera(pendingInput);
+			currentCamera = captureCameraState();
+			pendingInput.xTurn = pendingInput.yTurn = pendingInput.scroll = 0.0f;
+		}
 
 		// Resize window and graphics simultaneously
 		glfwGetFramebufferSize(window, &width, &height);
-		glViewport(0, 0, width, height);
 
-		// Set background color
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// Declare identity matrix
-		glm::mat4 modelMatrix = glm::mat4(1.0f);
-		glm::mat4 projectionMatrix = glm::mat4(1.0f);
+		// Camera interpolated to this frame's time; its matrices are only rebuilt when pose, lens or size changed
+		CameraState renderCamera = interpolateCameraState(previousCamera, currentCamera, simulation.alpha());
+		camera.setPose(renderCamera.position, renderCamera.front, cameraUp);
+		camera.setLens(fov, perspective, reverseDepth);
+		camera.setViewport(width, height);
 
-		// Use executable shader program and select VAO before drawing 
-		glUseProgram(shaderProgram); // Call Shader per-frame when updating attributes
+		// Nothing on screen can have changed: keep presenting the last frame and sleep until input arrives
+		if (redrawRequested)
+		{
+			redraw.requestRedraw();
+			redrawRequested = false;
+		}
+		if (!redraw.needsRedraw(camera.version(), scene.dynamicTransforms().size() > 0))
+		{
+			PROFILE_SCOPE("Idle");
+			pacer.frameSkipped();
+			previousInputTime = -1.0;
+			glfwWaitEventsTimeout(idleWaitSeconds);
+
+			// The camera was at rest while asleep; a key that ended the wait must not be applied to that time
+			lastFrame = glfwGetTime();
+			continue;
+		}
 
-		// lookAt functin used to create view matrix that transforms all world coordinates to view space
-		viewMatrix = glm::lookAt(cameraPosition, cameraPosition + cameraFront, cameraUp);
+		// The list submitted this frame was built from last frame's input when pipelined
+		double submittedInputTime = pipelineFrames ? previousInputTime : inputTime;
+		previousInputTime = inputTime;
 
-		// Conditional loop allows user to change view of scene between orthographic (2D) and perspective (3D) views
-		if (perspective)
+		// Switch depth convention and (re)create the offscreen target to match the window and depth format
+		if (reverseDepth != appliedReverseDepth)
+		{
+			applyDepthConvention(reverseDepth);
+			appliedReverseDepth = reverseDepth;
+		}
+		bool offscreen = reverseDepth || dynamicResolution;
+		if (offscreen && (sceneTarget.width() != width || sceneTarget.height() != height || sceneTarget.floatDepth() != reverseDepth))
 		{
-			projectionMatrix = glm::perspective(glm::radians(fov), (GLfloat)width / (GLfloat)height, 0.1f, 100.0f);
+			sceneTarget.destroy();
+			sceneTarget.create(width, height, reverseDepth);
 		}
 
-		else{
-			float scale = 100;
-			projectionMatrix = glm::ortho(-((float)width / scale), (float)width / scale, -(float)height / scale, ((float)height / scale), -50.0f, 50.0f);
+		// Scene GPU time measured two frames ago picks this frame's scale; the aspect ratio stays the window's
+		double sceneMs = 0.0;
+		while (dynamicResolution && sceneTimer.read(sceneMs))
+		{
+			resolution.update(sceneMs);
+		}
+		float renderScale = dynamicResolution ? resolution.scale() : 1.0f;
+		int renderWidth = max(1, (int)(width * renderScale + 0.5f));
+		int renderHeight = max(1, (int)(height * renderScale + 0.5f));
+		if (offscreen)
+		{
+			sceneTarget.bind();
+		}
+		glViewport(0, 0, renderWidth, renderHeight);
+		if (dynamicResolution)
+		{
+			sceneTimer.begin();
 		}
 
-		// Select uniform shader and variable
-		GLuint modelLoc = glGetUniformLocation(shaderProgram, "model");
-		GLuint viewLoc = glGetUniformLocation(shaderProgram, "view");
-		GLuint projectionLoc = glGetUniformLocation(shaderProgram, "projection");
+		// Set background color
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		// Pass transform to shader
-		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(modelMatrix));
-		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(viewMatrix));
-		glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
+		// Use executable shader program and select VAO before drawing 
+		renderState.useProgram(shaderProgram); // Only reaches GL when another program was bound
+		scene.setLodView(camera.position(), camera.perspective() ? camera.fov() : 0.0f);
 
-		// Draw Plane
-		glBindVertexArray(VAO1);
-		modelMatrix = glm::mat4(1.0f); // Declare identity matrix
-		modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 5.0f, 0.0f)); // Translate on x axis
-		modelMatrix = glm::rotate(modelMatrix, glm::degrees(0.0f), glm::vec3(1.0f, 0.3f, 0.5f)); // Rotate along y axis
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		// Spin the extra donut boxes
+		animateDemoScene(scene, currentFrame);
 
-		// Draw Almond milk base
-		glBindVertexArray(VAO2);
-		modelMatrix = glm::mat4(1.0f); // Declare identity matrix
-		modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 5.0f, 0.0f)); 
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+		// Cull the scene and group visible objects into a draw list on the worker threads
+		pipeline.startBuild(scene, scenePool, camera.view(), camera.projection());
 
-		// Draw Almond milk top
-		glBindVertexArray(VAO3);
-		modelMatrix = glm::mat4(1.0f); // Declare identity matrix
-		modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 5.0f, 0.0f)); 
-		glDrawArrays(GL_TRIANGLES, 0, 42);
+		// Meanwhile submit last frame's list (this frame's once it is built, without pipelining)
+		const DrawList* drawList = pipeline.listToSubmit();
+		if (drawList)
+		{
+			// Camera matrices the list was built with go to the shared uniform buffer, only when they changed
+			cameraBuffer.update(drawList->view, drawList->projection);
+
+			// Upload every visible object's model matrix in one bulk copy
+			{
+				PROFILE_SCOPE("Upload instances");
+				PROFILE_GPU_SCOPE("Upload instances");
+				scenePool.uploadInstances(drawList->transforms.data(), drawList->transforms.size());
+			}
+
+			// Occluders depth-only, Hi-Z pyramid and per-instance test, all on the GPU
+			if (occlusionCulling)
+			{
+				PROFILE_SCOPE("Occlusion cull");
+				PROFILE_GPU_SCOPE("Occlusion cull");
+				occlusion.cull(scenePool, renderState, drawList->batches.data(), drawList->batches.size(), appliedReverseDepth);
+			}
+
+			// Draw plane, Almond milk base, Almond milk top and donut box in one submission
+			{
+				PROFILE_SCOPE("Draw");
+				PROFILE_GPU_SCOPE("Draw");
+				if (occlusionCulling)
+				{
+					occlusion.draw(scenePool, renderState, drawList->batches.data(), drawList->batches.size());
+				}
+				else
+				{
+					scenePool.draw(renderState, drawList->batches.data(), drawList->batches.size());
+				}
+			}
+		}
+
+		if (dynamicResolution)
+		{
+			sceneTimer.end();
+		}
+
+		// The scene may only change again once this frame's build is done
+		pipeline.endFrame();
+
+		// Copy the offscreen frame to the window, bilinearly stretched when it was rendered smaller
+		if (offscreen)
+		{
+			PROFILE_GPU_SCOPE("Blit");
+			bool scaled = renderWidth != width || renderHeight != height;
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneTarget.handle());
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, width, height, GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		}
 
-		// Draw donut box
-		glBindVertexArray(VAO4);
-		modelMatrix = glm::mat4(1.0f); // Declare identity matrix
-		modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 5.0f, 0.0f));
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-		
-		// Deactivate VAO
-		glBindVertexArray(0);
+		// Program and VAO stay bound across frames; the render state knows what is current
 
-		// Deactivate program object
-		glUseProgram(0);
+		// Report state changes and draws issued and elided by the render state once per second
+		framesSinceStats++;
+		if (currentFrame - lastStatsReport >= 1.0f)
+		{
+			// Counted before printing, which may allocate itself
+			unsigned long long allocations = heapAllocationCount() - lastStatsAllocations;
+			const RenderCounters& counters = renderState.frameCounters();
+			cout << "State changes and draws this frame (program/VAO binds, draw calls): " << counters.issued << " issued, " << counters.elided << " elided; "
+				<< "objects visible: " << scene.visibleCount() << " / " << scene.objectCount() << endl;
+			const StreamStats& stream = scenePool.streamStats();
+			cout << "Streamed last frame: " << stream.bytesUploaded / 1024.0 << " KB, fence wait " << stream.fenceWaitMs << " ms"
+				<< (scenePool.streamBuffer().persistent() ? "" : " (no buffer storage, orphaning)") << endl;
+			if (drawList)
+			{
+				const DrawSortStats& sorting = drawList->sortStats;
+				cout << "State changes: " << sorting.unsortedChanges << " unsorted, " << sorting.sortedChanges << " sorted into "
+					<< drawList->batches.size() << " batches (" << sorting.sortMs << " ms)" << endl;
+			}
+			cout << "Draw list built in " << pipeline.buildMs() << " ms on " << jobs.threadCount() << " threads, GL thread waited "
+				<< pipeline.waitMs() << " ms" << endl;
+			const ArenaStats& arena = scene.arenaStats();
+			if (occlusionCulling)
+			{
+				const OcclusionStats& hidden = occlusion.stats();
+				cout << "Occlusion: " << hidden.occluded << " of " << hidden.tested << " instances hidden behind " << hidden.occluderInstances
+					<< " occluders; Hi-Z " << occlusion.pyramidWidth() << "x" << occlusion.pyramidHeight() << ", " << occlusion.pyramidLevels() << " levels" << endl;
+			}
+			if (dynamicResolution)
+			{
+				const ResolutionStats& scaling = resolution.stats();
+				cout << "Resolution: scale " << renderScale << " (" << renderWidth << "x" << renderHeight << "), scene GPU " << (scaling.frames ? scaling.totalMs / scaling.frames : 0.0)
+					<< " ms of " << resolution.budgetMs() << " ms budget; within budget " << scaling.budgetHits << " / " << scaling.frames
+					<< " frames, " << scaling.scaleChanges << " scale changes" << endl;
+				resolution.clearStats();
+			}
+			const LatencyHistogram& latency = pacer.latency();
+			cout << "Input to present over " << latency.count() << " frames: ";
+			latency.print(cout);
+			cout << endl;
+			cout << "Pacing: swap interval " << pacer.swapInterval() << ", waited " << pacer.sleptMs() << " ms for frame slots" << endl;
+			cout << "Camera uploads: " << cameraBuffer.uploads() << " in total; frames skipped while idle: " << redraw.skipped() << endl;
+			cout << "Heap allocations: " << (double)allocations / framesSinceStats << " per frame; frame arena " << arena.bytesUsed / 1024
+				<< " KB of " << arena.capacity / 1024 << " KB" << endl;
+			lastStatsReport = currentFrame;
+			lastStatsAllocations = heapAllocationCount();
+			framesSinceStats = 0;
+			pacer.clearStats();
+		}
 
 		// Swap front and back buffers of window
-		glfwSwapBuffers(window);
+		{
+			PROFILE_SCOPE("Swap buffers");
+			glfwSwapBuffers(window);
+		}
+		pacer.presented(drawList ? submittedInputTime : -1.0);
+	}
 
-		// Process events
-		glfwPollEvents();
+	if (tracePath)
+	{
+		writeChromeTrace(tracePath);
+	}
+	gpuProfiler.destroy();
+	cameraBuffer.destroy();
+	sceneTarget.destroy();
+	sceneTimer.destroy();
+	occlusion.destroy();
+	shaderCache.destroy();
+
+	if (recorder.isOpen())
+	{
+		recorder.close();
+		cout << "Recorded " << simulation.ticks() << " ticks (" << recorder.recordCount() << " input records) to " << recordingPath << endl;
 	}
 
-	// Delete Vertex Array Objects and Vertex Buffer Objects
-	glDeleteVertexArrays(1, &VAO1);
-	glDeleteBuffers(1, &VBO1);
-	glDeleteVertexArrays(1, &VAO2);
-	glDeleteBuffers(1, &VBO2);
-	glDeleteVertexArrays(1, &VAO3);
-	glDeleteBuffers(1, &VBO3);
-	glDeleteVertexArrays(1, &VAO4);
-	glDeleteBuffers(1, &VBO4);
+	// Delete Vertex Array Object and Vertex Buffer Object
+	scenePool.destroy();
 
 	// End program
 	glfwTerminate();
@@ -483,61 +758,55 @@ void processInput(GLFWwindow* window)
 		glfwSetWindowShouldClose(window, true);					
 	}
 	
-	cameraSpeed = cameraMovement * delataTime;					// Calculate camera speed based on scroll
-
+	// Collect held movement keys for the next simulation tick
+	unsigned int keys = 0;
 	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)			// If 'W' pressed, move camera forward (toward object)	
 	{
-		cameraPosition += cameraSpeed * cameraFront;
+		keys |= MoveForward;
 	}
 	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)			// If 'S' pressed, move camera backward (away from object)	
 	{
-		cameraPosition -= cameraSpeed * cameraFront;
+		keys |= MoveBackward;
 	}
 	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)			// If 'A' pressed, move camera left	
 	{
-		cameraPosition -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+		keys |= MoveLeft;
 	}
 	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)			// If 'D' pressed, move camera right	
 	{
-		cameraPosition += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+		keys |= MoveRight;
 	}
 	if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)			// If 'Q' pressed, move camera down	
 	{
-		cameraPosition -= cameraSpeed * cameraUp;
+		keys |= MoveDown;
 	}
 	if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)			// If 'E' pressed, move camera up	
 	{
-		cameraPosition += cameraSpeed * cameraUp;
+		keys |= MoveUp;
+	}
+	if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS)			// If 'F' pressed, reset camera on the next tick
+	{
+		keys |= ResetCamera;
 	}
+	pendingInput.keys = keys;
+
 	if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)			// If "P" key pressed, change perspective
 	{
 		perspective = !perspective;
 	}
-	if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS)			// If 'F' pressed, call function to reset camera
+
+	bool depthKey = glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS;
+	if (depthKey && !depthKeyDown && reverseDepthSupported())	// If "Z" key pressed, switch between standard and reverse-Z depth
 	{
-		initCamera();
+		reverseDepth = !reverseDepth;
 	}
+	depthKeyDown = depthKey;
 }
 
 // Control speed at which camera moves with scroll; Adjust the speed of the movement
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
-	// Clamp cameraMovement
-	if (cameraMovement >= 1.0f && cameraMovement <= 55.0f)
-	{
-		cameraMovement -= yoffset;
-	}
-
-	// Default cameraMovement
-	if (cameraMovement < 1.0f)
-	{
-		cameraMovement = 1.0f;
-	}
-
-	if (cameraMovement > 55.0f)
-	{
-		cameraMovement = 55.0f;
-	}
+	pendingInput.scroll += yoffset;		// Applied on the next simulation tick
 }
 
 // Allows to change the orientation of the camera
@@ -558,41 +827,13 @@ void cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
 	lastX = xpos;
 	lastY = ypos;
 
-	// Lessen sensitivity of mouse movement
-	GLfloat sensitivity = 0.1f;
-	xChange *= sensitivity;
-	yChange *= sensitivity;
-
-	// Add ofset values to global yaw and pitch
-	yaw += xChange;
-	pitch += yChange;
-
-	// Prevent screen from flipping
-	if (pitch > 89.0f)
-	{
-		pitch = 89.0f;
-	}
-	if (pitch < -89.0f)
-	{
-		pitch = -89.0f;
-	}
-
-	// Calculate actual direction vector to contain rotations from mouse movement
-	glm::vec3 front;
-	front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
-	front.y = sin(glm::radians(pitch));
-	front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
-	cameraFront = glm::normalize(front);
+	// Accumulate until the next simulation tick turns the camera
+	pendingInput.xTurn += xChange;
+	pendingInput.yTurn += yChange;
 }
 
-// Function with coordinates to reset camera to look at scene
-void initCamera()
+// Window was exposed or damaged; draw it again even if nothing moved
+void window_refresh_callback(GLFWwindow* window)
 {
-	cameraPosition = glm::vec3(0.0f, -3.0f, 15.0f);
-	target = glm::vec3(0.0f, 0.0f, 0.0f);
-	cameraDirection = glm::normalize(cameraPosition - target);
-	worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
-	cameraRight = glm::normalize(glm::cross(worldUp, cameraDirection));
-	cameraUp = glm::normalize(glm::cross(cameraDirection, cameraRight));
-	cameraFront = glm::normalize(glm::vec3(0.0f, 0.0f, -1.0f));
-}
\ No newline at end of file
+	redrawRequested = true;
+}
@@ -0,0 +1,152 @@
+#include "StreamBuffer.h"
+
+#include <chrono>
+
+void StreamBuffer::create(GLsizeiptr bytesPerFrame, int frames)
+{
+	regionCount = frames;
+	persistentMapping = GLEW_ARB_buffer_storage != GL_FALSE;
+	createBuffer(bytesPerFrame);
+}
+
+void StreamBuffer::createBuffer(GLsizeiptr regionBytes)
+{
+	regionSize = regionBytes;
+	fences.assign(regionCount, (GLsync)0);
+	region = 0;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	if (persistentMapping)
+	{
+		// Immutable storage, mapped once for the lifetime of the buffer
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, regionSize * regionCount, NULL, flags);
+		mapped = (GLubyte*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, regionSize * regionCount, flags);
+	}
+	else
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, regionSize, NULL, GL_STREAM_DRAW);
+		staging.resize(regionSize);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void StreamBuffer::releaseBuffer()
+{
+	for (GLsync& fence : fences)
+	{
+		if (fence)
+		{
+			glDeleteSync(fence);
+			fence = 0;
+		}
+	}
+	// Deleting unmaps; GL keeps the storage alive until submitted draws have read it
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+	mapped = nullptr;
+}
+
+void StreamBuffer::destroy()
+{
+	releaseBuffer();
+	glDeleteBuffers((GLsizei)retired.size(), retired.data());
+	retired.clear();
+	std::vector<GLubyte>().swap(staging);
+	frameStarted = false;
+}
+
+void StreamBuffer::beginFrame()
+{
+	if (frameStarted)
+	{
+		// Everything reading the previous region has been submitted by now
+		if (persistentMapping)
+		{
+			fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			region = (region + 1) % regionCount;
+		}
+		lastStats = stats;
+	}
+	frameStarted = true;
+	stats = StreamStats();
+	used = flushed = 0;
+
+	glDeleteBuffers((GLsizei)retired.size(), retired.data());
+	retired.clear();
+
+	GLsync& fence = fences[region];
+	if (fence)
+	{
+		// Usually signaled already: the region was last used regionCount frames ago
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+			do
+			{
+				result = glClientWaitSync(fence, flags, 1000000);	// 1 ms per try
+				flags = 0;
+			} while (result == GL_TIMEOUT_EXPIRED);
+			stats.fenceWaitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			stats.fenceWaits = 1;
+		}
+		glDeleteSync(fence);
+		fence = 0;
+	}
+
+	if (!persistentMapping)
+	{
+		// Orphan last frame's storage so this frame's copies do not wait for draws still reading it
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, regionSize, NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+}
+
+StreamAllocation StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+	GLsizeiptr start = (used + alignment - 1) / alignment * alignment;
+	if (start + size > regionSize)
+	{
+		// Frame does not fit: move to a buffer twice as large (or large enough) and keep the old one until next frame
+		flush();
+		GLsizeiptr newSize = regionSize * 2 > size ? regionSize * 2 : size;
+		newSize = (newSize + 255) / 256 * 256;		// Keep region starts aligned for every allocation alignment in use
+		retired.push_back(buffer);
+		buffer = 0;
+		for (GLsync& fence : fences)
+		{
+			if (fence)
+			{
+				glDeleteSync(fence);
+			}
+		}
+		createBuffer(newSize);
+		stats.grows++;
+		start = 0;
+		used = flushed = 0;
+	}
+
+	StreamAllocation allocation;
+	allocation.buffer = buffer;
+	allocation.offset = (persistentMapping ? region * regionSize : 0) + start;
+	allocation.pointer = persistentMapping ? (void*)(mapped + allocation.offset) : (void*)(staging.data() + start);
+	used = start + size;
+	stats.bytesUploaded += size;
+	return allocation;
+}
+
+void StreamBuffer::flush()
+{
+	if (persistentMapping || flushed == used)
+	{
+		return;
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, flushed, used - flushed, staging.data() + flushed);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	flushed = used;
+}
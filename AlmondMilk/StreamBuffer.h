@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <GL/glew.h>        // GLEW library
+
+// Upload counters of the last finished frame
+struct StreamStats
+{
+	GLsizeiptr bytesUploaded = 0;	// Bytes handed out by allocate()
+	double fenceWaitMs = 0.0;		// CPU time spent waiting for the GPU to release the frame's region
+	unsigned int fenceWaits = 0;	// Frames that had to wait at all
+	unsigned int grows = 0;			// Times the buffer was reallocated because a frame did not fit
+};
+
+// Space handed out for one upload; bind 'buffer' and use 'offset', the buffer can change when the ring grows
+struct StreamAllocation
+{
+	void* pointer;
+	GLuint buffer;
+	GLintptr offset;
+};
+
+// Streaming upload ring. One buffer, persistently and coherently mapped (GL_ARB_buffer_storage), split into
+// 'frames' regions. Each frame writes into its own region and the region is fenced when the next frame begins,
+// so a region is only rewritten after the GPU has finished with it; nothing ever waits on an implicit sync.
+// Without buffer storage, allocations are staged in memory and flush() copies them into an orphaned buffer.
+class StreamBuffer
+{
+public:
+	void create(GLsizeiptr bytesPerFrame, int frames = 3);
+	void destroy();
+
+	// Fence the previous frame's region and wait, if needed, until the next one is free again
+	void beginFrame();
+
+	// Reserve space in the current frame's region. Grows the ring if the frame does not fit;
+	// earlier allocations of this frame stay valid in the old buffer.
+	StreamAllocation allocate(GLsizeiptr size, GLsizeiptr alignment);
+
+	void flush();					// Make this frame's writes visible to GL (no-op when persistently mapped)
+
+	bool persistent() const { return persistentMapping; }
+	const StreamStats& frameStats() const { return lastStats; }
+
+private:
+	void createBuffer(GLsizeiptr regionBytes);
+	void releaseBuffer();
+
+	GLuint buffer = 0;
+	GLubyte* mapped = nullptr;				// Persistent mapping of the whole buffer
+	std::vector<GLubyte> staging;			// Used instead of the mapping without buffer storage
+	std::vector<GLsync> fences;				// One per region; zero while the region is free
+	std::vector<GLuint> retired;			// Outgrown buffers, deleted once the frame using them is submitted
+	GLsizeiptr regionSize = 0;
+	int regionCount = 0;
+	int region = 0;							// Region written this frame
+	GLsizeiptr used = 0;					// Bytes allocated this frame
+	GLsizeiptr flushed = 0;					// Bytes already copied by flush() without buffer storage
+	bool persistentMapping = false;
+	bool frameStarted = false;
+	StreamStats stats, lastStats;
+};
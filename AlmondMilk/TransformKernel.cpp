@@ -0,0 +1,185 @@
+#include "TransformKernel.h"
+#include "TransformKernelImpl.h"
+
+#include <cmath>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Implemented in TransformKernelAVX2.cpp, which is compiled with AVX2 enabled; does whole groups of 8 objects
+size_t transformAndCullAVX2(const TransformStreams& objects, size_t first, size_t count, const float* planes, float* world, unsigned char* visible);
+
+size_t TransformSoA::add(const glm::vec3& position, const glm::vec3& axis, float angle, const glm::vec3& scale, const AABB& bounds)
+{
+	size_t i = size();
+	positionX.push_back(0.0f); positionY.push_back(0.0f); positionZ.push_back(0.0f);
+	rotationX.push_back(0.0f); rotationY.push_back(0.0f); rotationZ.push_back(0.0f); rotationW.push_back(1.0f);
+	scaleX.push_back(scale.x); scaleY.push_back(scale.y); scaleZ.push_back(scale.z);
+
+	glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+	glm::vec3 extent = (bounds.max - bounds.min) * 0.5f;
+	centerX.push_back(center.x); centerY.push_back(center.y); centerZ.push_back(center.z);
+	extentX.push_back(extent.x); extentY.push_back(extent.y); extentZ.push_back(extent.z);
+
+	setPosition(i, position);
+	setRotation(i, axis, angle);
+	return i;
+}
+
+void TransformSoA::setPosition(size_t i, const glm::vec3& position)
+{
+	positionX[i] = position.x;
+	positionY[i] = position.y;
+	positionZ[i] = position.z;
+}
+
+// Same rotation as glm::rotate(angle, axis), stored as a unit quaternion
+void TransformSoA::setRotation(size_t i, const glm::vec3& axis, float angle)
+{
+	glm::vec3 unitAxis = glm::normalize(axis);
+	float s = sin(angle * 0.5f);
+	rotationX[i] = unitAxis.x * s;
+	rotationY[i] = unitAxis.y * s;
+	rotationZ[i] = unitAxis.z * s;
+	rotationW[i] = cos(angle * 0.5f);
+}
+
+KernelPath detectKernelPath()
+{
+#if defined(_MSC_VER)
+	// AVX2 needs the CPU feature bit and the OS saving YMM registers (OSXSAVE + XCR0 bits 1 and 2)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] >= 7)
+	{
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		__cpuidex(info, 7, 0);
+		bool avx2 = (info[1] & (1 << 5)) != 0;
+		if (osxsave && avx && avx2 && (_xgetbv(0) & 0x6) == 0x6)
+		{
+			return AVX2Kernel;
+		}
+	}
+	return SSEKernel;		// SSE2 is the baseline for both Win32 and x64 builds
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return AVX2Kernel;
+	}
+	return __builtin_cpu_supports("sse2") ? SSEKernel : ScalarKernel;
+#else
+	return ScalarKernel;
+#endif
+}
+
+const char* kernelPathName(KernelPath path)
+{
+	switch (path)
+	{
+	case AVX2Kernel: return "AVX2";
+	case SSEKernel: return "SSE";
+	default: return "scalar";
+	}
+}
+
+// One object at a time; also handles the tail the wide kernels leave over
+static void transformAndCullScalar(const TransformSoA& in, const Frustum& frustum, size_t first, size_t count, glm::mat4* world, unsigned char* visible)
+{
+	for (size_t i = first; i < first + count; i++)
+	{
+		float qx = in.rotationX[i], qy = in.rotationY[i], qz = in.rotationZ[i], qw = in.rotationW[i];
+		float sx = in.scaleX[i], sy = in.scaleY[i], sz = in.scaleZ[i];
+
+		glm::mat4& m = world[i];
+		m[0] = glm::vec4((1.0f - 2.0f * (qy * qy + qz * qz)) * sx, 2.0f * (qx * qy + qw * qz) * sx, 2.0f * (qx * qz - qw * qy) * sx, 0.0f);
+		m[1] = glm::vec4(2.0f * (qx * qy - qw * qz) * sy, (1.0f - 2.0f * (qx * qx + qz * qz)) * sy, 2.0f * (qy * qz + qw * qx) * sy, 0.0f);
+		m[2] = glm::vec4(2.0f * (qx * qz + qw * qy) * sz, 2.0f * (qy * qz - qw * qx) * sz, (1.0f - 2.0f * (qx * qx + qy * qy)) * sz, 0.0f);
+		m[3] = glm::vec4(in.positionX[i], in.positionY[i], in.positionZ[i], 1.0f);
+
+		glm::vec3 center(in.centerX[i], in.centerY[i], in.centerZ[i]);
+		glm::vec3 extent(in.extentX[i], in.extentY[i], in.extentZ[i]);
+		glm::vec3 centerW = glm::vec3(m[0]) * center.x + glm::vec3(m[1]) * center.y + glm::vec3(m[2]) * center.z + glm::vec3(m[3]);
+		glm::vec3 extentW = glm::abs(glm::vec3(m[0])) * extent.x + glm::abs(glm::vec3(m[1])) * extent.y + glm::abs(glm::vec3(m[2])) * extent.z;
+
+		unsigned char inside = 1;
+		for (int p = 0; p < 6; p++)
+		{
+			glm::vec3 normal(frustum.planes[p]);
+			float distance = glm::dot(normal, centerW) + frustum.planes[p].w;
+			float radius = glm::dot(glm::abs(normal), extentW);
+			if (distance + radius < 0.0f)
+			{
+				inside = 0;
+				break;
+			}
+		}
+		visible[i] = inside;
+	}
+}
+
+// SSE register operations for the shared kernel
+struct SSEOps
+{
+	typedef __m128 Register;
+	static const int width = 4;
+	static Register load(const float* p) { return _mm_loadu_ps(p); }
+	static Register set1(float v) { return _mm_set1_ps(v); }
+	static Register zero() { return _mm_setzero_ps(); }
+	static Register allTrue() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+	static Register add(Register a, Register b) { return _mm_add_ps(a, b); }
+	static Register sub(Register a, Register b) { return _mm_sub_ps(a, b); }
+	static Register mul(Register a, Register b) { return _mm_mul_ps(a, b); }
+	static Register abs(Register a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+	static Register bitAnd(Register a, Register b) { return _mm_and_ps(a, b); }
+	static Register greaterEqual(Register a, Register b) { return _mm_cmpge_ps(a, b); }
+	static int moveMask(Register a) { return _mm_movemask_ps(a); }
+	static void storeMatrices(const Register* m, float* out) { storeMatrices4(m, out); }
+};
+
+void transformAndCull(KernelPath path, const TransformSoA& objects, size_t first, size_t count, const Frustum& frustum, glm::mat4* world, unsigned char* visible)
+{
+	// The wide kernels take raw arrays; world matrices and planes are tightly packed floats
+	const TransformStreams streams =
+	{
+		objects.positionX.data(), objects.positionY.data(), objects.positionZ.data(),
+		objects.rotationX.data(), objects.rotationY.data(), objects.rotationZ.data(), objects.rotationW.data(),
+		objects.scaleX.data(), objects.scaleY.data(), objects.scaleZ.data(),
+		objects.centerX.data(), objects.centerY.data(), objects.centerZ.data(),
+		objects.extentX.data(), objects.extentY.data(), objects.extentZ.data()
+	};
+	const float* planes = glm::value_ptr(frustum.planes[0]);
+	float* worldFloats = glm::value_ptr(world[0]);
+
+	size_t wide = 0;
+	if (path == AVX2Kernel)
+	{
+		wide = transformAndCullAVX2(streams, first, count, planes, worldFloats, visible);
+	}
+	else if (path == SSEKernel)
+	{
+		wide = count - count % SSEOps::width;
+		transformAndCullWide<SSEOps>(streams, planes, first, wide, worldFloats, visible);
+	}
+	transformAndCullScalar(objects, frustum, first + wide, count - wide, world, visible);
+}
+
+void transformAndCull(const TransformSoA& objects, size_t first, size_t count, const Frustum& frustum, glm::mat4* world, unsigned char* visible)
+{
+	static const KernelPath bestPath = detectKernelPath();
+	transformAndCull(bestPath, objects, first, count, frustum, world, visible);
+}
+
+void transformAndCull(KernelPath path, const TransformSoA& objects, const Frustum& frustum, glm::mat4* world, unsigned char* visible)
+{
+	transformAndCull(path, objects, 0, objects.size(), frustum, world, visible);
+}
+
+void transformAndCull(const TransformSoA& objects, const Frustum& frustum, glm::mat4* world, unsigned char* visible)
+{
+	transformAndCull(objects, 0, objects.size(), frustum, world, visible);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+
+// GLM Libraries
+#include <glm/glm.hpp> 
+
+#include "Culling.h"
+
+// Object transforms stored as a structure of arrays so the kernel can process several objects at once
+struct TransformSoA
+{
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> rotationX, rotationY, rotationZ, rotationW;	// Unit quaternion
+	std::vector<float> scaleX, scaleY, scaleZ;
+	std::vector<float> centerX, centerY, centerZ;					// Model-space bounds center
+	std::vector<float> extentX, extentY, extentZ;					// Model-space bounds half size
+
+	size_t size() const { return positionX.size(); }
+
+	// Append object placed like translate(position) * rotate(angle, axis) * scale(scale); returns its index
+	size_t add(const glm::vec3& position, const glm::vec3& axis, float angle, const glm::vec3& scale, const AABB& bounds);
+	void setPosition(size_t i, const glm::vec3& position);
+	void setRotation(size_t i, const glm::vec3& axis, float angle);
+};
+
+// Instruction set used by the kernel
+enum KernelPath
+{
+	ScalarKernel,
+	SSEKernel,		// 4 objects per iteration
+	AVX2Kernel		// 8 objects per iteration
+};
+
+KernelPath detectKernelPath();				// Widest path supported by this CPU and OS
+const char* kernelPathName(KernelPath path);
+
+// Build every world matrix and test its world bounds against the frustum.
+// visible[i] is set to 1 when object i touches the frustum, 0 otherwise.
+void transformAndCull(const TransformSoA& objects, const Frustum& frustum, glm::mat4* world, unsigned char* visible);
+void transformAndCull(KernelPath path, const TransformSoA& objects, const Frustum& frustum, glm::mat4* world, unsigned char* visible);
+
+// Same for objects [first, first + count) only, so separate threads can each take a range of one array
+void transformAndCull(const TransformSoA& objects, size_t first, size_t count, const Frustum& frustum, glm::mat4* world, unsigned char* visible);
+void transformAndCull(KernelPath path, const TransformSoA& objects, size_t first, size_t count, const Frustum& frustum, glm::mat4* world, unsigned char* visible);
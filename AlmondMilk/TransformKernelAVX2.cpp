@@ -0,0 +1,51 @@
+// AVX2 path of the transform and cull kernel. Only called after detectKernelPath() found AVX2 support;
+// the project compiles this file alone with /arch:AVX2.
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2")
+#endif
+
+// Nothing from std or glm may be used here, only TransformKernelImpl.h and intrinsics
+#include "TransformKernelImpl.h"
+
+namespace
+{
+	// AVX register operations for the shared kernel
+	struct AVX2Ops
+	{
+		typedef __m256 Register;
+		static const int width = 8;
+		static Register load(const float* p) { return _mm256_loadu_ps(p); }
+		static Register set1(float v) { return _mm256_set1_ps(v); }
+		static Register zero() { return _mm256_setzero_ps(); }
+		static Register allTrue() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+		static Register add(Register a, Register b) { return _mm256_add_ps(a, b); }
+		static Register sub(Register a, Register b) { return _mm256_sub_ps(a, b); }
+		static Register mul(Register a, Register b) { return _mm256_mul_ps(a, b); }
+		static Register abs(Register a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+		static Register bitAnd(Register a, Register b) { return _mm256_and_ps(a, b); }
+		static Register greaterEqual(Register a, Register b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+		static int moveMask(Register a) { return _mm256_movemask_ps(a); }
+
+		// Split each register into objects 0-3 and 4-7 and write them with the SSE transpose
+		static void storeMatrices(const Register* m, float* out)
+		{
+			__m128 low[16], high[16];
+			for (int e = 0; e < 16; e++)
+			{
+				low[e] = _mm256_castps256_ps128(m[e]);
+				high[e] = _mm256_extractf128_ps(m[e], 1);
+			}
+			storeMatrices4(low, out);
+			storeMatrices4(high, out + 4 * 16);
+		}
+	};
+}
+
+// Returns how many objects from 'first' were done, a multiple of 8; the caller finishes the rest
+size_t transformAndCullAVX2(const TransformStreams& objects, size_t first, size_t count, const float* planes, float* world, unsigned char* visible)
+{
+	size_t wide = count - count % AVX2Ops::width;
+	transformAndCullWide<AVX2Ops>(objects, planes, first, wide, world, visible);
+	_mm256_zeroupper();
+	return wide;
+}
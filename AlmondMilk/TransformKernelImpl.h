@@ -0,0 +1,108 @@
+#pragma once
+// Width-generic transform and cull kernel, included by the SSE and AVX2 translation units.
+// Everything lives in an unnamed namespace so each unit keeps its own copy compiled for its instruction set.
+// The kernel sees raw float arrays only: an inline std or glm function used here would be compiled with VEX
+// encoding in the AVX2 unit, and the linker may keep that copy for the whole program.
+#include <cstddef>
+#include <immintrin.h>
+
+// TransformSoA arrays as plain pointers
+struct TransformStreams
+{
+	const float* positionX, * positionY, * positionZ;
+	const float* rotationX, * rotationY, * rotationZ, * rotationW;
+	const float* scaleX, * scaleY, * scaleZ;
+	const float* centerX, * centerY, * centerZ;
+	const float* extentX, * extentY, * extentZ;
+};
+
+namespace
+{
+	// Compute world matrices (16 floats each, column-major like glm::mat4) and frustum visibility for objects
+	// [first, first + count); count must be a multiple of V::width. Planes are six x, y, z, w quadruples.
+	template <class V>
+	void transformAndCullWide(const TransformStreams& in, const float* planes, size_t first, size_t count, float* world, unsigned char* visible)
+	{
+		typedef typename V::Register R;
+		const R one = V::set1(1.0f);
+		const R two = V::set1(2.0f);
+
+		// Broadcast plane coefficients once
+		R planeX[6], planeY[6], planeZ[6], planeW[6];
+		for (int p = 0; p < 6; p++)
+		{
+			planeX[p] = V::set1(planes[p * 4 + 0]);
+			planeY[p] = V::set1(planes[p * 4 + 1]);
+			planeZ[p] = V::set1(planes[p * 4 + 2]);
+			planeW[p] = V::set1(planes[p * 4 + 3]);
+		}
+
+		for (size_t i = first; i < first + count; i += V::width)
+		{
+			R qx = V::load(in.rotationX + i), qy = V::load(in.rotationY + i), qz = V::load(in.rotationZ + i), qw = V::load(in.rotationW + i);
+			R sx = V::load(in.scaleX + i), sy = V::load(in.scaleY + i), sz = V::load(in.scaleZ + i);
+
+			// Rotation matrix from quaternion, columns scaled by the object scale
+			R xx = V::mul(qx, qx), yy = V::mul(qy, qy), zz = V::mul(qz, qz);
+			R xy = V::mul(qx, qy), xz = V::mul(qx, qz), yz = V::mul(qy, qz);
+			R wx = V::mul(qw, qx), wy = V::mul(qw, qy), wz = V::mul(qw, qz);
+
+			R m[16];
+			m[0] = V::mul(V::sub(one, V::mul(two, V::add(yy, zz))), sx);
+			m[1] = V::mul(V::mul(two, V::add(xy, wz)), sx);
+			m[2] = V::mul(V::mul(two, V::sub(xz, wy)), sx);
+			m[3] = V::zero();
+			m[4] = V::mul(V::mul(two, V::sub(xy, wz)), sy);
+			m[5] = V::mul(V::sub(one, V::mul(two, V::add(xx, zz))), sy);
+			m[6] = V::mul(V::mul(two, V::add(yz, wx)), sy);
+			m[7] = V::zero();
+			m[8] = V::mul(V::mul(two, V::add(xz, wy)), sz);
+			m[9] = V::mul(V::mul(two, V::sub(yz, wx)), sz);
+			m[10] = V::mul(V::sub(one, V::mul(two, V::add(xx, yy))), sz);
+			m[11] = V::zero();
+			m[12] = V::load(in.positionX + i);
+			m[13] = V::load(in.positionY + i);
+			m[14] = V::load(in.positionZ + i);
+			m[15] = one;
+			V::storeMatrices(m, world + i * 16);
+
+			// World bounds: transformed center, extent grown by the absolute rotation/scale
+			R cx = V::load(in.centerX + i), cy = V::load(in.centerY + i), cz = V::load(in.centerZ + i);
+			R ex = V::load(in.extentX + i), ey = V::load(in.extentY + i), ez = V::load(in.extentZ + i);
+			R centerW[3], extentW[3];
+			for (int row = 0; row < 3; row++)
+			{
+				centerW[row] = V::add(V::add(V::mul(m[row], cx), V::mul(m[4 + row], cy)), V::add(V::mul(m[8 + row], cz), m[12 + row]));
+				extentW[row] = V::add(V::add(V::mul(V::abs(m[row]), ex), V::mul(V::abs(m[4 + row]), ey)), V::mul(V::abs(m[8 + row]), ez));
+			}
+
+			// Box is outside if it lies fully behind any plane: distance + projected radius < 0
+			R inside = V::allTrue();
+			for (int p = 0; p < 6; p++)
+			{
+				R distance = V::add(V::add(V::mul(planeX[p], centerW[0]), V::mul(planeY[p], centerW[1])), V::add(V::mul(planeZ[p], centerW[2]), planeW[p]));
+				R radius = V::add(V::add(V::mul(V::abs(planeX[p]), extentW[0]), V::mul(V::abs(planeY[p]), extentW[1])), V::mul(V::abs(planeZ[p]), extentW[2]));
+				inside = V::bitAnd(inside, V::greaterEqual(V::add(distance, radius), V::zero()));
+			}
+			int mask = V::moveMask(inside);
+			for (int lane = 0; lane < V::width; lane++)
+			{
+				visible[i + lane] = (unsigned char)((mask >> lane) & 1);
+			}
+		}
+	}
+
+	// Write four objects' matrices from 16 registers holding one element each
+	inline void storeMatrices4(const __m128* m, float* out)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			__m128 r0 = m[column * 4 + 0], r1 = m[column * 4 + 1], r2 = m[column * 4 + 2], r3 = m[column * 4 + 3];
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(out + 0 * 16 + column * 4, r0);
+			_mm_storeu_ps(out + 1 * 16 + column * 4, r1);
+			_mm_storeu_ps(out + 2 * 16 + column * 4, r2);
+			_mm_storeu_ps(out + 3 * 16 + column * 4, r3);
+		}
+	}
+}